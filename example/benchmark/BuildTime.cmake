@@ -0,0 +1,110 @@
+#
+# Compile and link times of proxies with large listings
+#
+# Configures the benchmark project in BUILD_DIR with only the build time proxies, then compiles and links each one on
+# its own and prints how long each step took along with the object and DLL sizes:
+#   cmake -DBUILD_DIR=build-time -P example/benchmark/BuildTime.cmake
+#   cmake -DBUILD_DIR=build-time-mingw -DTOOLCHAIN_FILE=example/benchmark/mingw-w64-x86_64.cmake -P example/benchmark/BuildTime.cmake
+#
+# Optional: COUNTS (export counts, default 1000;2000;5000;10000;20000), GENERATOR, TOOLCHAIN_FILE and RESULTS_FILE
+# (also write the results as CSV). Times are wall clock and include build tool startup. Linker memory isn't measured.
+# MSVC has no ranges listing because DECLARE_PROXIED_API_ORDINAL_RANGE needs a GNU toolchain.
+#
+cmake_minimum_required(VERSION 3.26)
+
+if(NOT BUILD_DIR)
+	message(FATAL_ERROR "BUILD_DIR must be set")
+endif()
+
+if(NOT COUNTS)
+	set(COUNTS 1000 2000 5000 10000 20000)
+endif()
+
+get_filename_component(BUILD_DIR "${BUILD_DIR}" ABSOLUTE)
+
+# Lists can't be passed on the command line of a child cmake, so they go through an initial cache script
+file(
+	WRITE "${BUILD_DIR}/BuildTimeCache.cmake"
+	"set(DLLPROXY_BENCHMARK_EXPORT_COUNTS \"\" CACHE STRING \"\" FORCE)\n"
+	"set(DLLPROXY_BENCHMARK_BUILD_TIME_COUNTS \"${COUNTS}\" CACHE STRING \"\" FORCE)\n"
+)
+
+set(CONFIGURE_ARGS -S "${CMAKE_CURRENT_LIST_DIR}" -B "${BUILD_DIR}" -C "${BUILD_DIR}/BuildTimeCache.cmake" -DCMAKE_BUILD_TYPE=Release)
+
+if(GENERATOR)
+	list(APPEND CONFIGURE_ARGS -G "${GENERATOR}")
+endif()
+
+if(TOOLCHAIN_FILE)
+	get_filename_component(TOOLCHAIN_FILE "${TOOLCHAIN_FILE}" ABSOLUTE)
+	list(APPEND CONFIGURE_ARGS "-DCMAKE_TOOLCHAIN_FILE=${TOOLCHAIN_FILE}")
+endif()
+
+function(run_build_step OUT_MILLISECONDS)
+	string(TIMESTAMP START_TIME "%s%f")
+	execute_process(
+		COMMAND ${ARGN}
+		RESULT_VARIABLE RESULT
+		OUTPUT_VARIABLE OUTPUT
+		ERROR_VARIABLE OUTPUT
+	)
+	string(TIMESTAMP END_TIME "%s%f")
+
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "Step failed: ${ARGN}\n${OUTPUT}")
+	endif()
+
+	math(EXPR ELAPSED "(${END_TIME} - ${START_TIME}) / 1000")
+	set(${OUT_MILLISECONDS} ${ELAPSED} PARENT_SCOPE)
+endfunction()
+
+function(format_seconds OUT_TEXT MILLISECONDS)
+	math(EXPR WHOLE "${MILLISECONDS} / 1000")
+	math(EXPR FRACTION "${MILLISECONDS} % 1000 + 1000")
+	string(SUBSTRING "${FRACTION}" 1 3 FRACTION)
+	set(${OUT_TEXT} "${WHOLE}.${FRACTION}" PARENT_SCOPE)
+endfunction()
+
+run_build_step(CONFIGURE_TIME "${CMAKE_COMMAND}" ${CONFIGURE_ARGS})
+format_seconds(CONFIGURE_TEXT ${CONFIGURE_TIME})
+message("Configured and generated listings in ${CONFIGURE_TEXT} s")
+
+set(CSV "exports,listing,compile_seconds,link_seconds,object_bytes,dll_bytes\n")
+message("exports  listing  compile (s)  link (s)  object (bytes)  dll (bytes)")
+
+foreach(EXPORT_COUNT IN LISTS COUNTS)
+	foreach(STYLE IN ITEMS lines ranges)
+		set(BUILD_TIME_NAME bench_buildtime_${STYLE}_${EXPORT_COUNT})
+		set(PATHS_FILE "${BUILD_DIR}/${BUILD_TIME_NAME}_Release.paths")
+
+		if(NOT EXISTS "${PATHS_FILE}")
+			continue()
+		endif()
+
+		# Clean first so every listing is compiled from scratch. Linking afterwards only has the DLL left to do.
+		run_build_step(
+			COMPILE_TIME
+			"${CMAKE_COMMAND}" --build "${BUILD_DIR}" --config Release --target ${BUILD_TIME_NAME}_objects --clean-first
+		)
+		run_build_step(
+			LINK_TIME
+			"${CMAKE_COMMAND}" --build "${BUILD_DIR}" --config Release --target ${BUILD_TIME_NAME}
+		)
+
+		file(STRINGS "${PATHS_FILE}" PATHS)
+		list(GET PATHS 0 OBJECT_PATH)
+		list(GET PATHS 1 DLL_PATH)
+		file(SIZE "${OBJECT_PATH}" OBJECT_SIZE)
+		file(SIZE "${DLL_PATH}" DLL_SIZE)
+
+		format_seconds(COMPILE_TEXT ${COMPILE_TIME})
+		format_seconds(LINK_TEXT ${LINK_TIME})
+
+		string(APPEND CSV "${EXPORT_COUNT},${STYLE},${COMPILE_TEXT},${LINK_TEXT},${OBJECT_SIZE},${DLL_SIZE}\n")
+		message("${EXPORT_COUNT}  ${STYLE}  ${COMPILE_TEXT}  ${LINK_TEXT}  ${OBJECT_SIZE}  ${DLL_SIZE}")
+	endforeach()
+endforeach()
+
+if(RESULTS_FILE)
+	file(WRITE "${RESULTS_FILE}" "${CSV}")
+endif()
@@ -0,0 +1,696 @@
+#include <initializer_list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <psapi.h>
+
+using PfnBenchInitialize = void(*)();
+using PfnBenchTarget = int(*)(int);
+using PfnBenchStubBytes = size_t(*)();
+using PfnBenchStubStart = const void *(*)();
+
+constexpr int DefaultIterations = 50;
+constexpr int CallsPerIteration = 10000000;
+
+static double ElapsedMicroseconds(const LARGE_INTEGER& Start, const LARGE_INTEGER& End, const LARGE_INTEGER& Frequency)
+{
+	return static_cast<double>(End.QuadPart - Start.QuadPart) * 1000000.0 / static_cast<double>(Frequency.QuadPart);
+}
+
+static int CompareDouble(const void *A, const void *B)
+{
+	const double a = *static_cast<const double *>(A);
+	const double b = *static_cast<const double *>(B);
+
+	return (a > b) - (a < b);
+}
+
+struct ResultField
+{
+	const char *Name;
+	double Value;
+};
+
+// With --json, every measurement becomes one object in a single array on stdout instead of a text line. Errors still
+// go to stderr so the array stays parseable.
+static bool JsonOutput = false;
+static int JsonRecordCount = 0;
+
+static void PrintJsonRecord(const char *Benchmark, const char *Variant, const char *ExportCount, std::initializer_list<ResultField> Fields)
+{
+	printf("%s\n  { \"benchmark\": \"%s\", \"variant\": \"%s\", \"exports\": %d", JsonRecordCount++ == 0 ? "[" : ",", Benchmark, Variant, atoi(ExportCount));
+
+	for (const auto& field : Fields)
+		printf(", \"%s\": %.3f", field.Name, field.Value);
+
+	printf(" }");
+}
+
+static void FinishJsonOutput()
+{
+	printf("%s\n", JsonRecordCount == 0 ? "[]" : "\n]");
+}
+
+static bool RunInitBenchmark(const char *Variant, const char *ExportCount, int Iterations)
+{
+	char proxyName[MAX_PATH];
+	snprintf(proxyName, sizeof(proxyName), "bench_proxy_%s_%s.dll", Variant, ExportCount);
+
+	// Drop any resolution cache left by an earlier run so the cold run has to write it
+	char cacheName[MAX_PATH];
+	snprintf(cacheName, sizeof(cacheName), "bench_proxy_%s_%s.cache", Variant, ExportCount);
+	DeleteFileA(cacheName);
+
+	const HMODULE proxy = LoadLibraryA(proxyName);
+
+	if (!proxy)
+	{
+		fprintf(stderr, "Failed to load %s (error %lu)\n", proxyName, GetLastError());
+		return false;
+	}
+
+	const auto benchInitialize = reinterpret_cast<PfnBenchInitialize>(GetProcAddress(proxy, "BenchInitialize"));
+
+	if (!benchInitialize)
+	{
+		fprintf(stderr, "%s doesn't export BenchInitialize\n", proxyName);
+		return false;
+	}
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	// The first run includes loading the original DLL from disk
+	QueryPerformanceCounter(&start);
+	benchInitialize();
+	QueryPerformanceCounter(&end);
+
+	const double coldTime = ElapsedMicroseconds(start, end, frequency);
+	auto samples = static_cast<double *>(malloc(Iterations * sizeof(double)));
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		QueryPerformanceCounter(&start);
+		benchInitialize();
+		QueryPerformanceCounter(&end);
+
+		samples[i] = ElapsedMicroseconds(start, end, frequency);
+	}
+
+	qsort(samples, Iterations, sizeof(double), CompareDouble);
+
+	if (JsonOutput)
+		PrintJsonRecord("init", Variant, ExportCount, { { "cold_us", coldTime }, { "min_us", samples[0] }, { "median_us", samples[Iterations / 2] } });
+	else
+		printf("resolver=%-14s exports=%-6s cold=%10.2fus min=%10.2fus median=%10.2fus\n", Variant, ExportCount, coldTime, samples[0], samples[Iterations / 2]);
+
+	free(samples);
+	return true;
+}
+
+static int RunStartupChild(const char *ProxyName)
+{
+	// Mimics a host process that links against the proxy: load, initialize, exit. No proxied function is called.
+	const HMODULE proxy = LoadLibraryA(ProxyName);
+
+	if (!proxy)
+		return 1;
+
+	const auto benchInitialize = reinterpret_cast<PfnBenchInitialize>(GetProcAddress(proxy, "BenchInitialize"));
+
+	if (!benchInitialize)
+		return 1;
+
+	benchInitialize();
+	return 0;
+}
+
+static int RunLoaderLockChild(const char *ProxyName)
+{
+	// LoadLibrary holds the loader lock from mapping the proxy until its TLS callbacks and DllMain return. Other
+	// threads can't load or unload modules in the meantime.
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	QueryPerformanceCounter(&start);
+	const HMODULE proxy = LoadLibraryA(ProxyName);
+	QueryPerformanceCounter(&end);
+
+	if (!proxy)
+		return 1;
+
+	printf("%f\n", ElapsedMicroseconds(start, end, frequency));
+	return 0;
+}
+
+static int RunRebaseChild(const char *ProxyName)
+{
+	// Load once to find where the image lands, then reserve that range so the timed load has to relocate it. A
+	// relocated image gets private copies of every page that a base relocation writes to.
+	HMODULE proxy = LoadLibraryA(ProxyName);
+
+	if (!proxy)
+		return 1;
+
+	const auto base = reinterpret_cast<uintptr_t>(proxy);
+	const auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+	const auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+	const size_t imageSize = ntHeaders->OptionalHeader.SizeOfImage;
+
+	FreeLibrary(proxy);
+
+	if (!VirtualAlloc(reinterpret_cast<void *>(base), imageSize, MEM_RESERVE, PAGE_NOACCESS))
+		return 1;
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	QueryPerformanceCounter(&start);
+	proxy = LoadLibraryA(ProxyName);
+	QueryPerformanceCounter(&end);
+
+	if (!proxy || reinterpret_cast<uintptr_t>(proxy) == base)
+		return 1;
+
+	printf("%f\n", ElapsedMicroseconds(start, end, frequency));
+	return 0;
+}
+
+// Runs the runner again as "<runner> <ChildMode> <proxy>" and reads back the one number the child prints
+static bool RunChildSample(const char *ChildMode, const char *Variant, const char *ExportCount, double *Sample)
+{
+	char runnerPath[MAX_PATH];
+	char commandLine[2 * MAX_PATH];
+
+	GetModuleFileNameA(nullptr, runnerPath, ARRAYSIZE(runnerPath));
+	snprintf(commandLine, sizeof(commandLine), "\"%s\" %s bench_proxy_%s_%s.dll", runnerPath, ChildMode, Variant, ExportCount);
+
+	SECURITY_ATTRIBUTES pipeAttributes = { sizeof(pipeAttributes), nullptr, TRUE };
+	HANDLE readPipe = nullptr;
+	HANDLE writePipe = nullptr;
+
+	if (!CreatePipe(&readPipe, &writePipe, &pipeAttributes, 0))
+		return false;
+
+	SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+
+	STARTUPINFOA startupInfo = { sizeof(startupInfo) };
+	PROCESS_INFORMATION processInfo = {};
+
+	startupInfo.dwFlags = STARTF_USESTDHANDLES;
+	startupInfo.hStdOutput = writePipe;
+	startupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	const BOOL started = CreateProcessA(nullptr, commandLine, nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startupInfo, &processInfo);
+	CloseHandle(writePipe);
+
+	if (!started)
+	{
+		fprintf(stderr, "Failed to start %s (error %lu)\n", commandLine, GetLastError());
+		CloseHandle(readPipe);
+		return false;
+	}
+
+	char output[64] = {};
+	DWORD outputLength = 0;
+
+	ReadFile(readPipe, output, sizeof(output) - 1, &outputLength, nullptr);
+	WaitForSingleObject(processInfo.hProcess, INFINITE);
+
+	DWORD exitCode = 0;
+	GetExitCodeProcess(processInfo.hProcess, &exitCode);
+	CloseHandle(processInfo.hThread);
+	CloseHandle(processInfo.hProcess);
+	CloseHandle(readPipe);
+
+	if (exitCode != 0 || outputLength == 0)
+	{
+		fprintf(stderr, "Child process failed to load bench_proxy_%s_%s.dll\n", Variant, ExportCount);
+		return false;
+	}
+
+	*Sample = atof(output);
+	return true;
+}
+
+static bool RunLoaderLockBenchmark(const char *Variant, const char *ExportCount, int Iterations)
+{
+	// Each sample comes from a fresh process so the original DLL is never already loaded
+	auto samples = static_cast<double *>(malloc(Iterations * sizeof(double)));
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		if (!RunChildSample("--lock", Variant, ExportCount, &samples[i]))
+		{
+			free(samples);
+			return false;
+		}
+	}
+
+	qsort(samples, Iterations, sizeof(double), CompareDouble);
+
+	if (JsonOutput)
+		PrintJsonRecord("loaderlock", Variant, ExportCount, { { "min_us", samples[0] }, { "median_us", samples[Iterations / 2] } });
+	else
+		printf("lock     init=%-14s exports=%-6s min=%10.2fus median=%10.2fus\n", Variant, ExportCount, samples[0], samples[Iterations / 2]);
+
+	free(samples);
+	return true;
+}
+
+// Counts the base relocations that patch the stub section. The loader writes to every stub page one of them falls
+// in whenever the image doesn't load at its preferred base.
+static bool CountStubRelocations(HMODULE Module, size_t *Count)
+{
+	const auto benchStubStart = reinterpret_cast<PfnBenchStubStart>(GetProcAddress(Module, "BenchStubStart"));
+	const auto benchStubBytes = reinterpret_cast<PfnBenchStubBytes>(GetProcAddress(Module, "BenchStubBytes"));
+
+	if (!benchStubStart || !benchStubBytes)
+		return false;
+
+	const auto base = reinterpret_cast<uintptr_t>(Module);
+	const auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+	const auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+	const auto& directory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+
+	const uintptr_t stubStart = reinterpret_cast<uintptr_t>(benchStubStart()) - base;
+	const uintptr_t stubEnd = stubStart + benchStubBytes();
+	uintptr_t offset = 0;
+
+	*Count = 0;
+
+	while (offset + sizeof(IMAGE_BASE_RELOCATION) <= directory.Size)
+	{
+		const auto block = reinterpret_cast<const IMAGE_BASE_RELOCATION *>(base + directory.VirtualAddress + offset);
+
+		if (block->SizeOfBlock < sizeof(IMAGE_BASE_RELOCATION))
+			break;
+
+		const auto entries = reinterpret_cast<const WORD *>(block + 1);
+		const size_t entryCount = (block->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+
+		for (size_t i = 0; i < entryCount; i++)
+		{
+			// Padding at the end of a block
+			if ((entries[i] >> 12) == IMAGE_REL_BASED_ABSOLUTE)
+				continue;
+
+			const uintptr_t rva = block->VirtualAddress + (entries[i] & 0xFFF);
+
+			if (rva >= stubStart && rva < stubEnd)
+				(*Count)++;
+		}
+
+		offset += block->SizeOfBlock;
+	}
+
+	return true;
+}
+
+static bool RunRebaseBenchmark(const char *Variant, const char *ExportCount, int Iterations)
+{
+	char proxyName[MAX_PATH];
+	snprintf(proxyName, sizeof(proxyName), "bench_proxy_%s_%s.dll", Variant, ExportCount);
+
+	const HMODULE proxy = LoadLibraryA(proxyName);
+
+	if (!proxy)
+	{
+		fprintf(stderr, "Failed to load %s (error %lu)\n", proxyName, GetLastError());
+		return false;
+	}
+
+	size_t stubRelocations = 0;
+
+	if (!CountStubRelocations(proxy, &stubRelocations))
+	{
+		fprintf(stderr, "%s doesn't export BenchStubStart and BenchStubBytes\n", proxyName);
+		return false;
+	}
+
+	// Position independent stubs exist so there's nothing to relocate
+	if (strcmp(Variant, "relative") == 0 && stubRelocations != 0)
+	{
+		fprintf(stderr, "%s has %zu base relocations in its stub section, expected none\n", proxyName, stubRelocations);
+		return false;
+	}
+
+	auto samples = static_cast<double *>(malloc(Iterations * sizeof(double)));
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		if (!RunChildSample("--rebased", Variant, ExportCount, &samples[i]))
+		{
+			free(samples);
+			return false;
+		}
+	}
+
+	qsort(samples, Iterations, sizeof(double), CompareDouble);
+
+	if (JsonOutput)
+	{
+		PrintJsonRecord("rebase", Variant, ExportCount, {
+			{ "stub_relocs", static_cast<double>(stubRelocations) },
+			{ "min_us", samples[0] },
+			{ "median_us", samples[Iterations / 2] },
+		});
+	}
+	else
+	{
+		printf("rebase   stub=%-14s exports=%-6s relocs=%6zu min=%10.2fus median=%10.2fus\n",
+			Variant, ExportCount, stubRelocations, samples[0], samples[Iterations / 2]);
+	}
+
+	free(samples);
+	return true;
+}
+
+static bool RunStartupBenchmark(const char *Variant, const char *ExportCount, int Iterations)
+{
+	char runnerPath[MAX_PATH];
+	char commandLine[2 * MAX_PATH];
+
+	GetModuleFileNameA(nullptr, runnerPath, ARRAYSIZE(runnerPath));
+	snprintf(commandLine, sizeof(commandLine), "\"%s\" --load bench_proxy_%s_%s.dll", runnerPath, Variant, ExportCount);
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	auto samples = static_cast<double *>(malloc(Iterations * sizeof(double)));
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		STARTUPINFOA startupInfo = { sizeof(startupInfo) };
+		PROCESS_INFORMATION processInfo = {};
+
+		QueryPerformanceCounter(&start);
+
+		if (!CreateProcessA(nullptr, commandLine, nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+		{
+			fprintf(stderr, "Failed to start %s (error %lu)\n", commandLine, GetLastError());
+			free(samples);
+			return false;
+		}
+
+		WaitForSingleObject(processInfo.hProcess, INFINITE);
+		QueryPerformanceCounter(&end);
+
+		DWORD exitCode = 0;
+		GetExitCodeProcess(processInfo.hProcess, &exitCode);
+		CloseHandle(processInfo.hThread);
+		CloseHandle(processInfo.hProcess);
+
+		if (exitCode != 0)
+		{
+			fprintf(stderr, "Child process failed to load bench_proxy_%s_%s.dll\n", Variant, ExportCount);
+			free(samples);
+			return false;
+		}
+
+		samples[i] = ElapsedMicroseconds(start, end, frequency);
+	}
+
+	qsort(samples, Iterations, sizeof(double), CompareDouble);
+
+	if (JsonOutput)
+		PrintJsonRecord("startup", Variant, ExportCount, { { "min_us", samples[0] }, { "median_us", samples[Iterations / 2] } });
+	else
+		printf("startup  resolver=%-14s exports=%-6s min=%10.2fus median=%10.2fus\n", Variant, ExportCount, samples[0], samples[Iterations / 2]);
+
+	free(samples);
+	return true;
+}
+
+static bool RunCallBenchmark(const char *Label, const char *ExportCount, const char *ModuleName, bool Initialize, double *BaselineMedian)
+{
+	const HMODULE module = LoadLibraryA(ModuleName);
+
+	if (!module)
+	{
+		fprintf(stderr, "Failed to load %s (error %lu)\n", ModuleName, GetLastError());
+		return false;
+	}
+
+	if (Initialize)
+	{
+		const auto benchInitialize = reinterpret_cast<PfnBenchInitialize>(GetProcAddress(module, "BenchInitialize"));
+
+		if (!benchInitialize)
+		{
+			fprintf(stderr, "%s doesn't export BenchInitialize\n", ModuleName);
+			return false;
+		}
+
+		benchInitialize();
+	}
+
+	// Volatile so the compiler can't hoist or devirtualize the call out of the loop
+	PfnBenchTarget volatile target = reinterpret_cast<PfnBenchTarget>(GetProcAddress(module, "BenchExport_1"));
+
+	if (!target)
+	{
+		fprintf(stderr, "%s doesn't export BenchExport_1\n", ModuleName);
+		return false;
+	}
+
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+
+	auto samples = static_cast<double *>(malloc(DefaultIterations * sizeof(double)));
+	int accumulator = 0;
+
+	for (int i = 0; i < DefaultIterations; i++)
+	{
+		const PfnBenchTarget function = target;
+
+		QueryPerformanceCounter(&start);
+
+		for (int j = 0; j < CallsPerIteration; j++)
+			accumulator = function(accumulator);
+
+		QueryPerformanceCounter(&end);
+
+		samples[i] = ElapsedMicroseconds(start, end, frequency) * 1000.0 / CallsPerIteration;
+	}
+
+	qsort(samples, DefaultIterations, sizeof(double), CompareDouble);
+
+	// The baseline run fills in its own median. Stub runs report their median relative to it.
+	const double median = samples[DefaultIterations / 2];
+
+	if (!Initialize)
+		*BaselineMedian = median;
+
+	if (JsonOutput)
+		PrintJsonRecord("calls", Label, ExportCount, { { "min_ns", samples[0] }, { "median_ns", median }, { "overhead_ns", median - *BaselineMedian } });
+	else
+		printf("calls    stub=%-14s exports=%-6s min=%8.3fns/call median=%8.3fns/call overhead=%8.3fns/call (%d)\n", Label, ExportCount, samples[0], median, median - *BaselineMedian, accumulator);
+
+	free(samples);
+	return true;
+}
+
+static bool RunWorkingSetBenchmark(const char *Variant, const char *ExportCount)
+{
+	char proxyName[MAX_PATH];
+	snprintf(proxyName, sizeof(proxyName), "bench_proxy_%s_%s.dll", Variant, ExportCount);
+
+	const HMODULE proxy = LoadLibraryA(proxyName);
+
+	if (!proxy)
+	{
+		fprintf(stderr, "Failed to load %s (error %lu)\n", proxyName, GetLastError());
+		return false;
+	}
+
+	const auto benchInitialize = reinterpret_cast<PfnBenchInitialize>(GetProcAddress(proxy, "BenchInitialize"));
+
+	if (!benchInitialize)
+	{
+		fprintf(stderr, "%s doesn't export BenchInitialize\n", proxyName);
+		return false;
+	}
+
+	benchInitialize();
+
+	// Written pages are copy-on-write copies that only this process can use. Everything else that's resident is
+	// still backed by the image file and shared with other processes that load the same DLL.
+	const auto base = reinterpret_cast<uintptr_t>(proxy);
+	const auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+	const auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+	const size_t pageCount = (ntHeaders->OptionalHeader.SizeOfImage + 4095) / 4096;
+
+	// Stub pages are the part of the image that grows with the export count
+	const auto benchStubBytes = reinterpret_cast<PfnBenchStubBytes>(GetProcAddress(proxy, "BenchStubBytes"));
+	const size_t stubBytes = benchStubBytes ? benchStubBytes() : 0;
+
+	auto pages = static_cast<PSAPI_WORKING_SET_EX_INFORMATION *>(malloc(pageCount * sizeof(PSAPI_WORKING_SET_EX_INFORMATION)));
+
+	for (size_t i = 0; i < pageCount; i++)
+		pages[i].VirtualAddress = reinterpret_cast<void *>(base + i * 4096);
+
+	if (!K32QueryWorkingSetEx(GetCurrentProcess(), pages, static_cast<DWORD>(pageCount * sizeof(PSAPI_WORKING_SET_EX_INFORMATION))))
+	{
+		fprintf(stderr, "QueryWorkingSetEx failed (error %lu)\n", GetLastError());
+		free(pages);
+		return false;
+	}
+
+	size_t privatePages = 0;
+	size_t sharedPages = 0;
+
+	for (size_t i = 0; i < pageCount; i++)
+	{
+		if (!pages[i].VirtualAttributes.Valid)
+			continue;
+
+		if (pages[i].VirtualAttributes.Shared)
+			sharedPages++;
+		else
+			privatePages++;
+	}
+
+	if (JsonOutput)
+	{
+		PrintJsonRecord("footprint", Variant, ExportCount, {
+			{ "image_kb", static_cast<double>(pageCount * 4) },
+			{ "stubs_kb", static_cast<double>(stubBytes / 1024) },
+			{ "private_kb", static_cast<double>(privatePages * 4) },
+			{ "shared_kb", static_cast<double>(sharedPages * 4) },
+		});
+	}
+	else
+	{
+		printf("image    stub=%-14s exports=%-6s image=%8zuKB stubs=%8zuKB private=%8zuKB shared=%8zuKB\n",
+			Variant, ExportCount, pageCount * 4, stubBytes / 1024, privatePages * 4, sharedPages * 4);
+	}
+
+	free(pages);
+	return true;
+}
+
+static bool RunCallBenchmarks(const char *ExportCount)
+{
+	// Baseline is the original function called without a proxy in between
+	char originalName[MAX_PATH];
+	char indirectName[MAX_PATH];
+	char directName[MAX_PATH];
+	char readOnlyName[MAX_PATH];
+	char relativeName[MAX_PATH];
+
+	snprintf(originalName, sizeof(originalName), "bench_original_%s.dll", ExportCount);
+	snprintf(indirectName, sizeof(indirectName), "bench_proxy_getprocaddress_%s.dll", ExportCount);
+	snprintf(directName, sizeof(directName), "bench_proxy_direct_%s.dll", ExportCount);
+	snprintf(readOnlyName, sizeof(readOnlyName), "bench_proxy_readonly_%s.dll", ExportCount);
+	snprintf(relativeName, sizeof(relativeName), "bench_proxy_relative_%s.dll", ExportCount);
+
+	double baselineMedian = 0.0;
+
+	if (!RunCallBenchmark("none", ExportCount, originalName, false, &baselineMedian))
+		return false;
+
+	bool success = true;
+	success &= RunCallBenchmark("indirect", ExportCount, indirectName, true, &baselineMedian);
+	success &= RunCallBenchmark("direct", ExportCount, directName, true, &baselineMedian);
+	success &= RunCallBenchmark("readonly", ExportCount, readOnlyName, true, &baselineMedian);
+	success &= RunCallBenchmark("relative", ExportCount, relativeName, true, &baselineMedian);
+
+	return success;
+}
+
+int main(int argc, char **argv)
+{
+	// Usage: benchmark_runner [--json] [mode] <export count>... (defaults to the counts generated by CMakeLists.txt)
+	//
+	// Modes: (none)       DllProxy::Initialize time per resolver variant
+	//        --startup    whole child processes that load a proxy and exit
+	//        --calls      per-call cost through each stub kind against a direct call into the original
+	//        --workingset image, stub and private page footprint after initialization
+	//        --loaderlock LoadLibrary time of proxies that initialize from their TLS callback
+	//        --rebase     stub section base relocations and LoadLibrary time when the proxy can't load at its base
+	//        --all        the default mode, --calls and --workingset in one run
+	if (argc == 3 && strcmp(argv[1], "--load") == 0)
+		return RunStartupChild(argv[2]);
+
+	if (argc == 3 && strcmp(argv[1], "--lock") == 0)
+		return RunLoaderLockChild(argv[2]);
+
+	if (argc == 3 && strcmp(argv[1], "--rebased") == 0)
+		return RunRebaseChild(argv[2]);
+
+	JsonOutput = argc > 1 && strcmp(argv[1], "--json") == 0;
+
+	if (JsonOutput)
+	{
+		argc--;
+		argv++;
+	}
+
+	const bool startup = argc > 1 && strcmp(argv[1], "--startup") == 0;
+	const bool calls = argc > 1 && strcmp(argv[1], "--calls") == 0;
+	const bool workingSet = argc > 1 && strcmp(argv[1], "--workingset") == 0;
+	const bool loaderLock = argc > 1 && strcmp(argv[1], "--loaderlock") == 0;
+	const bool rebase = argc > 1 && strcmp(argv[1], "--rebase") == 0;
+	const bool all = argc > 1 && strcmp(argv[1], "--all") == 0;
+
+	if (startup || calls || workingSet || loaderLock || rebase || all)
+	{
+		argc--;
+		argv++;
+	}
+
+	const char *variants[] = { "getprocaddress", "exportdir", "deferred", "direct", "readonly", "relative", "cache" };
+	const char *loaderLockVariants[] = { "tlsinit", "warmup" };
+	const char *rebaseVariants[] = { "getprocaddress", "readonly", "relative" };
+	const char *defaultCounts[] = { "10", "100", "1000", "10000" };
+	const char **counts = argc > 1 ? const_cast<const char **>(&argv[1]) : defaultCounts;
+	const int countLength = argc > 1 ? argc - 1 : static_cast<int>(ARRAYSIZE(defaultCounts));
+	bool success = true;
+
+	for (int i = 0; i < countLength; i++)
+	{
+		if (loaderLock)
+		{
+			for (const char *variant : loaderLockVariants)
+				success &= RunLoaderLockBenchmark(variant, counts[i], DefaultIterations);
+
+			continue;
+		}
+
+		if (rebase)
+		{
+			for (const char *variant : rebaseVariants)
+				success &= RunRebaseBenchmark(variant, counts[i], DefaultIterations);
+
+			continue;
+		}
+
+		if (calls || all)
+			success &= RunCallBenchmarks(counts[i]);
+
+		if (calls)
+			continue;
+
+		for (const char *variant : variants)
+		{
+			if (startup)
+			{
+				success &= RunStartupBenchmark(variant, counts[i], DefaultIterations);
+				continue;
+			}
+
+			if (!workingSet)
+				success &= RunInitBenchmark(variant, counts[i], DefaultIterations);
+
+			if (workingSet || all)
+				success &= RunWorkingSetBenchmark(variant, counts[i]);
+		}
+	}
+
+	if (JsonOutput)
+		FinishJsonOutput();
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#
+# Cross-compiles the benchmark for x64 Windows with a mingw-w64 toolchain on Linux
+#
+set(CMAKE_SYSTEM_NAME Windows)
+set(CMAKE_SYSTEM_PROCESSOR AMD64)
+
+set(DLLPROXY_MINGW_PREFIX x86_64-w64-mingw32 CACHE STRING "mingw-w64 target triple")
+
+set(CMAKE_C_COMPILER ${DLLPROXY_MINGW_PREFIX}-gcc)
+set(CMAKE_CXX_COMPILER ${DLLPROXY_MINGW_PREFIX}-g++)
+set(CMAKE_RC_COMPILER ${DLLPROXY_MINGW_PREFIX}-windres)
+
+set(CMAKE_FIND_ROOT_PATH /usr/${DLLPROXY_MINGW_PREFIX})
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+
+# Wine runs the result, so try_run checks work too
+set(CMAKE_CROSSCOMPILING_EMULATOR wine)
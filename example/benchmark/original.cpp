@@ -0,0 +1,7 @@
+#include <windows.h>
+
+// Every export in the generated module.def aliases this function
+extern "C" int BenchTarget(int Value)
+{
+	return Value + 1;
+}
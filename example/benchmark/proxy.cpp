@@ -0,0 +1,28 @@
+#include <windows.h>
+
+#define DLL_PROXY_EXPORT_LISTING_FILE "ExportListing.inc"   // Generated per export count by CMakeLists.txt
+#define DLL_PROXY_DECLARE_IMPLEMENTATION                    // Define the whole implementation
+#include <QuickDllProxy/DllProxy.h>
+
+#define BENCH_EXPORT extern "C" __declspec(dllexport)
+
+// Not using TLS autoinit, so the runner decides when initialization happens and times it. The tlsinit and warmup
+// variants initialize during LoadLibrary instead.
+BENCH_EXPORT void BenchInitialize()
+{
+#if !defined(DLL_PROXY_TLS_CALLBACK_AUTOINIT)
+	DllProxy::Initialize();
+#endif
+}
+
+// MSVC merges the stub section into .text, so the runner can't find it in the section table
+BENCH_EXPORT size_t BenchStubBytes()
+{
+	return reinterpret_cast<uintptr_t>(&DllProxy::Section::ExportBoundaryEnd) - reinterpret_cast<uintptr_t>(&DllProxy::Section::ExportBoundaryStart);
+}
+
+// Where the stub section starts, so the runner can tell which base relocations patch stubs
+BENCH_EXPORT const void *BenchStubStart()
+{
+	return &DllProxy::Section::ExportBoundaryStart;
+}
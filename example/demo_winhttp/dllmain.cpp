@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <winhttp.h>
 #include <QuickDllProxy/DllProxy.h>                                    // Define the header only (forward declarations)
 
 void *ResolveModule()
@@ -6,20 +7,19 @@ void *ResolveModule()
 	return LoadLibraryA("C:\\windows\\system32\\winhttp.dll");
 }
 
-void ExampleHookedFunction()
+// Bound to WinHttpCrackUrl with DECLARE_PROXIED_API_ORDINAL_HOOK in winhttp_exports.inc. The stub jumps here directly.
+BOOL WINAPI ExampleHookedCrackUrl(LPCWSTR Url, DWORD UrlLength, DWORD Flags, LPURL_COMPONENTS Components)
 {
+	// Work before the real call goes here
+	const BOOL result = DllProxy::Original<&ExampleHookedCrackUrl>(Url, UrlLength, Flags, Components);
+
+	// Work after it goes here
+	return result;
 }
 
 bool ResolveFunction(void *Module, uint32_t Ordinal, const char *Name, void **Pointer)
 {
-    // Intercept a specific ordinal
-    if (Ordinal == 23)
-    {
-		*Pointer = &ExampleHookedFunction;
-		return true;
-    }
-
-    // Otherwise resolve it as normal through GetProcAddress
+    // Resolve it as normal through GetProcAddress
 	auto ptr = GetProcAddress((HMODULE)Module, Name);
 
     if (!ptr)
@@ -27,17 +27,141 @@
 //     Optional setting to enforce that all real exports are found during DllProxy::Initialize. If disabled,
 //     unresolved export errors will be deferred until proxy functions are invoked.
 //
+//   #define DLL_PROXY_DIRECT_JUMP_PATCHING
+//     Optional setting to patch each stub into a direct jmp rel32 during DllProxy::Initialize when the real function
+//     is within 2GB of it, which is always the case on x86. This saves a memory load and an indirect branch per call.
+//     Stubs that are out of range keep the indirect jump. Only applies to the default stubs.
+//
+//   #define DLL_PROXY_READ_ONLY_STUBS
+//     Optional setting to keep stubs read-only. Each stub jumps through its own pointer slot in writable data, so
+//     DllProxy::Initialize only writes pointers and never calls VirtualProtect or FlushInstructionCache on code. Stub
+//     pages stay shared between processes instead of becoming private copy-on-write pages. Stubs shrink to 8 bytes. x64
+//     stubs from GNU toolchains jump rip-relative and need no base relocation. MSVC has no x64 inline assembler, so its
+//     x64 stubs are 12 bytes and load the slot's address into rax. Can't be combined with DLL_PROXY_LAZY_BINDING,
+//     DLL_PROXY_ENABLE_CALL_STATS, DLL_PROXY_ENABLE_CALL_TRACING, or DLL_PROXY_DIRECT_JUMP_PATCHING.
+//
+//   #define DLL_PROXY_POSITION_INDEPENDENT_STUBS
+//     Optional setting to build stubs without absolute addresses, so the image needs no base relocation for them and a
+//     rebased proxy's stub pages aren't touched by the loader. x86 stubs become a single jmp rel32 that
+//     DllProxy::Initialize fills in. x64 stubs keep their RIP-relative jump but start with a null destination. With GNU
+//     toolchains both start out as a jmp rel32 to a thunk in the same section that reports an unresolved export, so
+//     calls made before DllProxy::Initialize fail the same way they do with the default stubs. MSVC can't compute that
+//     distance at compile time, so its stubs end the process with __fastfail(0xD9) instead, which shows up as
+//     STATUS_STACK_BUFFER_OVERRUN with 0xD9 as its first parameter. Can't be combined with DLL_PROXY_LAZY_BINDING,
+//     DLL_PROXY_ENABLE_CALL_STATS, DLL_PROXY_ENABLE_CALL_TRACING, or DLL_PROXY_READ_ONLY_STUBS.
+//
+//   #define DLL_PROXY_IMPORT_TABLE_BYPASS
+//     Optional setting to rewrite other modules' import address table entries that point at stubs so they point at the
+//     real functions instead. Calls through those entries skip the proxy entirely. It runs at the end of
+//     DllProxy::Initialize over every loaded module. DllProxy::BypassImportTables runs it again for modules loaded
+//     later and returns how many entries it rewrote. Hooked and unresolved exports keep their stubs, and
+//     DllProxy::Rebind updates rewritten entries too. GetProcAddress and delay-load imports still go through stubs.
+//     Can't be combined with DLL_PROXY_LAZY_BINDING, DLL_PROXY_ENABLE_CALL_STATS, or DLL_PROXY_ENABLE_CALL_TRACING.
+//
+//   #define DLL_PROXY_LAZY_BINDING
+//     Optional setting to resolve each export the first time it's called instead of during DllProxy::Initialize.
+//     Stubs start out pointing at a shared resolver thunk that looks up that single export, patches the stub, and
+//     tail jumps to the real function with all argument registers preserved. Initialization only loads the original
+//     library. Can't be combined with DLL_PROXY_CHECK_MISSING_EXPORTS.
+//
+//   #define DLL_PROXY_DEFERRED_LIBRARY_LOAD
+//     Optional setting to defer loading the original library until the first proxied function is called. Implies
+//     DLL_PROXY_LAZY_BINDING and turns DllProxy::Initialize into a no-op. No lock is held while the library resolver
+//     runs, so it may be invoked more than once if several threads make their first call at the same time. Handles
+//     that lose the race are passed to FreeLibrary, so custom resolvers must return a module they hold a reference to.
+//
+//   #define DLL_PROXY_BACKGROUND_WARMUP
+//     Optional setting to move bulk export resolution out of the loader lock. Implies DLL_PROXY_DEFERRED_LIBRARY_LOAD.
+//     DllProxy::Initialize only queues a thread pool work item that loads the original libraries and resolves every
+//     stub that hasn't resolved itself yet. The work item blocks on the loader lock until the load that triggered
+//     initialization completes. Stubs called before it finishes resolve themselves on the calling thread.
+//     Libraries that fail to load are skipped and report LibraryNotFound on the first call to one of their exports.
+//
+//   #define DLL_PROXY_ENABLE_CALL_STATS
+//     Optional setting to count how many times each proxy export is called. Stubs grow to 32 bytes and start with a
+//     locked increment of a cache line sized counter. DllProxy::QueryCallStatistics copies {name, ordinal, count} for
+//     up to Capacity exports into a caller provided array without allocating and returns the total export count. Can't
+//     be combined with DLL_PROXY_LAZY_BINDING.
+//
+//   #define DLL_PROXY_CALL_STATS_DUMP_PATH L"C:\\profile.txt"
+//     Optional setting to call DllProxy::WriteCallStatistics with the given path on DLL_PROCESS_DETACH via a TLS
+//     callback. The file has one "<count> <name>" line per export that was called, which tools/listing_generator
+//     accepts as a --profile to lay out the hottest stubs first.
+//
+//   #define DLL_PROXY_ENABLE_CALL_TRACING
+//     Optional setting to record every proxied call's export index, thread id, and rdtsc timestamps at entry and return
+//     into per-thread ring buffers. Stubs grow to 32 bytes and call through shared thunks that swap the caller's return
+//     address. DllProxy::WriteTraceDump writes the format described in DllProxyTrace.h, which tools/trace_decoder turns
+//     into per-export latency histograms. Calls left through longjmp or an exception aren't recorded, but the dump
+//     counts them. On x64 a vectored exception handler restores the swapped return addresses before unwinding starts,
+//     so calls that catch an exception internally aren't recorded either. Tracing stays off in processes that enforce
+//     CET shadow stacks, and switching fibers during a traced call isn't supported. Can't be combined with
+//     DLL_PROXY_LAZY_BINDING or DLL_PROXY_ENABLE_CALL_STATS.
+//
+//   #define DLL_PROXY_TRACE_RECORDS_PER_THREAD 16384
+//     Optional setting to define the ring buffer size, in records, allocated for each calling thread. Must be a power
+//     of two. Each record is 24 bytes.
+//
+//   #define DLL_PROXY_TRACE_DUMP_PATH L"C:\\trace.bin"
+//     Optional setting to call DllProxy::WriteTraceDump with the given path on DLL_PROCESS_DETACH via a TLS callback.
+//
+//   #define DLL_PROXY_ENABLE_INIT_REPORT
+//     Optional setting to time DllProxy::Initialize with QueryPerformanceCounter. DllProxy::GetInitReport returns a
+//     static report with the time spent resolving libraries, walking export directories and the resolution cache,
+//     resolving exports, in VirtualProtect, and flushing the instruction cache. It also counts exports that were
+//     resolved, missing, or null and keeps the 8 slowest resolutions. It doesn't allocate and can be read from the TLS
+//     callback or an exception callback. With DLL_PROXY_LAZY_BINDING only library resolution is measured.
+//
 //   #define DLL_PROXY_LIBRARY_RESOLVER_CALLBACK MyExampleLibraryResolver
 //     Optional setting to define a custom function that resolves a DLL's HMODULE. Signature identical to
-//     DllProxy::DefaultLibraryResolverCallback.
+//     DllProxy::DefaultLibraryResolverCallback. It's called once per DECLARE_PROXIED_LIBRARY with that library's
+//     name. Listings that declare a single library may also use a resolver without the LibraryName parameter.
 //
 //   #define DLL_PROXY_EXPORT_RESOLVER_CALLBACK MyExampleExportResolver
 //     Optional setting to define a custom function that resolves a DLL's exported function. Signature identical to
-//     DllProxy::DefaultExportResolverCallback.
+//     DllProxy::DefaultExportResolverCallback. Ordinal is 0 for exports the listing declared by name only, e.g. with
+//     DECLARE_PROXIED_API, so resolvers must look those up by Name and never pass ordinal 0 to GetProcAddress.
+//
+//   #define DLL_PROXY_EXPORT_DIRECTORY_RESOLVER
+//     Optional setting to resolve every export in a single merge pass over the original module's export directory
+//     instead of calling GetProcAddress once or twice per export. Forwarders are followed. Can't be combined with
+//     DLL_PROXY_EXPORT_RESOLVER_CALLBACK. DllProxy::ExportDirectoryResolverCallback offers the same lookup for a
+//     single export and can be called from custom resolvers.
+//
+//   #define DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+//     Optional setting to follow forwarder and API set chains, including forwarder strings returned by custom
+//     resolvers, down to the module that implements each export, so stubs reach it in one hop.
+//     DllProxy::QueryCollapsedExports copies {name, ordinal, depth} for up to Capacity collapsed exports into a caller
+//     provided array and returns how many exports were collapsed.
+//
+//   #define DLL_PROXY_COLLAPSE_IMPORT_THUNKS
+//     Optional setting to also skip import thunks that only jump through an import address table slot. Implies
+//     DLL_PROXY_COLLAPSE_EXPORT_CHAINS. Stubs jump to whatever the slot held at resolution time and never see later
+//     writes, so import hooks that other software installs on those slots afterwards are bypassed.
+//
+//   #define DLL_PROXY_MEMORY_LIBRARY_LOADER
+//     Optional setting to map original libraries from memory instead of loading them from disk. The default library
+//     resolver becomes DllProxy::MemoryLibraryResolverCallback, which finds an RT_RCDATA resource named after the
+//     library in this DLL, and exports are resolved with DllProxy::ExportDirectoryResolverCallback. Custom resolvers
+//     can pass their own buffer to DllProxy::LoadLibraryFromMemory. Relocations and imports are applied, then TLS
+//     callbacks and the entry point run with DLL_PROCESS_ATTACH. Mapped images are never unloaded, get no thread
+//     notifications, and can't be found with GetModuleHandle or GetProcAddress. Images with static TLS data
+//     (thread_local or __declspec(thread) variables) can't be given a TLS index and fail to load with
+//     ERROR_NOT_SUPPORTED. On x86 the image isn't registered with the loader, so its SEH handlers are rejected during
+//     exception dispatch and exceptions raised inside it can't be caught there. Can't be combined with
+//     DLL_PROXY_DEFERRED_LIBRARY_LOAD.
+//
+//   #define DLL_PROXY_RESOLUTION_CACHE_PATH L"C:\\DllProxy.cache"
+//     Optional setting to keep a file that maps each proxied export to its RVA in the original library. It's memory
+//     mapped during DllProxy::Initialize, and libraries whose TimeDateStamp, SizeOfImage, and CheckSum match the
+//     cached values skip export lookups entirely. Otherwise exports are resolved as usual and the file is replaced
+//     atomically. Exports that resolve outside their library's image, e.g. forwarders, are never cached. Resolvers
+//     must return the same pointer for the same module. Can't be combined with DLL_PROXY_LAZY_BINDING.
 //
 //   #define DLL_PROXY_EXCEPTION_CALLBACK MyExampleExceptionCallback
 //     Optional setting to define a custom function that's invoked on error. Signature identical to
-//     DllProxy::DefaultExceptionCallback.
+//     DllProxy::DefaultExceptionCallback. DllProxy::GetErrorLibraryName returns the original library that the error
+//     belongs to, or nullptr if it isn't tied to one.
 //
 //
 // Overview of the implementation:
@@ -54,12 +178,16 @@
 //
 //   4. Tell the linker to merge the ".dllprox" section into ".text".
 //
-//   5. At runtime DllProxy::Initialize patches a proxy stub's assembly opcodes such that it'll jump to the function
+//   5. Record each stub's name, ordinal, and address in a compile-time table (DllProxy::Section::ExportTable) so
+//      nothing has to parse this DLL's own PE headers at runtime. Exports declared without an ordinal are passed to
+//      the export resolver with an ordinal of 0.
+//
+//   6. At runtime DllProxy::Initialize patches a proxy stub's assembly opcodes such that it'll jump to the function
 //      back in the original DLL. By default, if the original function cannot be located, the proxy stub will raise an
 //      error only when invoked. If the developer defines DLL_PROXY_CHECK_MISSING_EXPORTS, the initialization routine
 //      fails up front instead.
 //
-//   6. "At runtime" is determined by the developer. Ideally one would use a static constructor that's executed before
+//   7. "At runtime" is determined by the developer. Ideally one would use a static constructor that's executed before
 //      DllMain but there's no hard requirement on where this happens. This implementation also provides an optional
 //      TLS callback to run DllProxy::Initialize early on in the loader process via DLL_PROXY_TLS_CALLBACK_AUTOINIT.
 //
@@ -68,6 +196,51 @@
 //
 //   Exported global variable forwarding isn't suppported.
 //
+//   Exports that never need to be intercepted can be declared with DECLARE_FORWARDED_API("Name", "module.Name") or
+//   DECLARE_FORWARDED_API_ORDINAL("Name", "module.Name", Ordinal) instead. These become PE forwarder exports that the
+//   loader resolves on its own: no stub, no patching during initialization, and no extra jump per call. The target
+//   module must be loadable by that name, e.g. a renamed copy of the original DLL placed next to the proxy.
+//
+//   Runs of unnamed exports can be declared with DECLARE_PROXIED_API_ORDINAL_RANGE(FirstOrdinal, LastOrdinal). Each
+//   ordinal gets a stub exported as "Ordinal_<N>" at ordinal N, the same name tools/listing_generator gives NONAME
+//   exports, and is resolved by ordinal. The whole range is one listing line and one stub array, so a DLL with
+//   thousands of unnamed exports compiles far faster than with a line per export. Ranges need a GNU toolchain and MSVC
+//   rejects them. Listings written with --ordinal-ranges wrap each range in #if defined(_MSC_VER) with one
+//   DECLARE_PROXIED_API_ORDINAL line per ordinal, so they build with both.
+//
+//   Exports can be intercepted with DECLARE_PROXIED_API_HOOK("Name", Hook) or
+//   DECLARE_PROXIED_API_ORDINAL_HOOK("Name", Ordinal, Hook). The stub jumps straight to Hook, and
+//   DllProxy::Original<&Hook> holds the real function with Hook's type, so work before and after the call is plain
+//   code around a direct call. Hooks must match the real signature and calling convention and be declared before the
+//   implementation is included. Exports without hooks get the same stubs as before.
+//
+//   DllProxy::Real<"Name">() returns the real function behind an export without another GetProcAddress. The name is
+//   looked up in the listing at compile time and a name that isn't declared there fails to compile. At runtime it's a
+//   load from the stub's destination, or from DllProxy::Original for hooked exports. A second template argument gives
+//   the pointer type, e.g. DllProxy::Real<"WinHttpConnect", decltype(&WinHttpConnect)>(). It returns nullptr if the
+//   export isn't resolved yet or wasn't found. With DLL_PROXY_LAZY_BINDING, unresolved exports are resolved first the
+//   same way a call through the stub would, except that a missing library or export returns nullptr instead of raising
+//   an error. Real can only be used in the source file that declares the implementation.
+//
+//   DllProxy::Rebind(NewModule, LibraryName, PreviousModule) moves every stub of one original library onto another
+//   module, e.g. a patched build loaded at runtime. LibraryName picks the DECLARE_PROXIED_LIBRARY to move and may be
+//   nullptr for the first one. Every export is resolved first and nothing changes unless all of them are found. Stubs
+//   are then repointed in one pass with atomic stores, so concurrent callers reach either the old or the new function.
+//   The previous module is returned through PreviousModule and stays loaded. Freeing it once no thread can still be
+//   running its code is up to the caller.
+//
+//   Stubs are laid out in the order their exports appear in the listing, so the first stubs share cache lines and the
+//   first page of the section. tools/listing_generator --profile <file> sorts each listing's exports by call count,
+//   hottest first. Profiles come from DllProxy::WriteCallStatistics or any text file with "<count> <name>" lines.
+//   Exports keep their names and ordinals. Only their position in the export table changes.
+//
+//   Listing files must not use __COUNTER__. Its values are used to index the compile-time export table. Compile time
+//   grows linearly with the number of listing lines. MSVC may need a larger /constexpr:steps for listings with tens of
+//   thousands of lines.
+//
+//   Listing files may contain more than one DECLARE_PROXIED_LIBRARY. Every export belongs to the library declared
+//   closest above it. DllProxy::Initialize loads each library and resolves its group of exports in turn.
+//
 //   DO NOT use CRT functions in callbacks. That includes printf, malloc, etc. The CRT may not be initialized. Certain
 //   C++ STL types work as long as they don't allocate memory.
 //
@@ -96,10 +269,12 @@
 //   EXPORTS
 //     Ordinal_1101 = PROXY_Ordinal_1101 @1101
 //     SymAllocDiaString = PROXY_SymAllocDiaString @1111
+//     SymFreeDiaString = dbghelp_orig.SymFreeDiaString @1112
 //
 #if !defined(DLLPROXY_H_DEDUP)
 #define DLLPROXY_H_DEDUP
 
+#include <cstddef>
 #include <cstdint>
 
 namespace DllProxy
@@ -135,19 +310,123 @@ namespace DllProxy
 		/// A proxy export was called but a real function pointer wasn't resolved yet.
 		/// </summary>
 		ExportNotResolved = 5,
+
+		/// <summary>
+		/// A traced call returned with a stack pointer that matches none of its thread's recorded calls.
+		/// </summary>
+		TraceStackMismatch = 6,
 	};
 
-	using PfnRealLibraryResolver = void *(*)();
+	using PfnRealLibraryResolver = void *(*)(const wchar_t *LibraryName);
 	using PfnRealExportResolver = bool(*)(void *Module, std::uint32_t Ordinal, const char *Name, void **FunctionPointer);
 	using PfnExceptionCallback = void(*)(ErrorCode Code);
 
+#if defined(DLL_PROXY_ENABLE_CALL_STATS)
+	struct CallStatistics
+	{
+		const char *Name;
+		std::uint32_t Ordinal;
+		std::uint64_t CallCount;
+	};
+#endif // DLL_PROXY_ENABLE_CALL_STATS
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+	struct InitReport
+	{
+		struct SlowExport
+		{
+			const char *Name;
+			std::uint32_t Ordinal;
+			std::int64_t Ticks;
+		};
+
+		// Times are in QueryPerformanceCounter ticks
+		std::int64_t CounterFrequency;
+		std::int64_t LibraryResolveTicks;
+		std::int64_t HeaderWalkTicks; // Export directory passes and resolution cache lookups
+		std::int64_t ExportResolveTicks; // Sum over every export
+		std::int64_t VirtualProtectTicks;
+		std::int64_t FlushTicks;
+		std::int64_t TotalTicks;
+
+		std::uint32_t ResolvedExports;
+		std::uint32_t MissingExports;
+		std::uint32_t NullExports; // Resolvers reported success without a function pointer
+
+		std::uint32_t SlowestExportCount;
+		SlowExport SlowestExports[8]; // Sorted from slowest to fastest
+	};
+#endif // DLL_PROXY_ENABLE_INIT_REPORT
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+	struct CollapsedExport
+	{
+		const char *Name;
+		std::uint32_t Ordinal;
+		std::uint32_t Depth; // Forwarders and import thunks between the original module's export and the real code
+	};
+#endif // DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+
+	// Real function behind an export declared with DECLARE_PROXIED_API_HOOK, typed like the hook itself. Written by
+	// DllProxy::Initialize (or the first call with DLL_PROXY_LAZY_BINDING) before the stub is sent to the hook.
+	template<auto Hook>
+	inline constinit decltype(Hook) Original = nullptr;
+
+	// Export name as a template argument for DllProxy::Real
+	template<std::size_t Length>
+	struct ExportName
+	{
+		char Value[Length];
+
+		consteval ExportName(const char (&Name)[Length])
+		{
+			for (std::size_t i = 0; i < Length; i++)
+				Value[i] = Name[i];
+		}
+	};
+
+	// Real function behind a proxied export, e.g. DllProxy::Real<"WinHttpConnect", decltype(&WinHttpConnect)>().
+	// The name is matched against the listing at compile time. Only defined where the implementation is declared.
+	template<ExportName Name, typename T = void *>
+	T Real();
+
 #if !defined(DLL_PROXY_TLS_CALLBACK_AUTOINIT)
 	void Initialize();
 #endif // !DLL_PROXY_TLS_CALLBACK_AUTOINIT
+
+	bool Rebind(void *NewModule, const wchar_t *LibraryName = nullptr, void **PreviousModule = nullptr);
 	
-	void *DefaultLibraryResolverCallback();
+	void *DefaultLibraryResolverCallback(const wchar_t *LibraryName);
 	bool DefaultExportResolverCallback(void *Module, std::uint32_t Ordinal, const char *Name, void **FunctionPointer);
+	bool ExportDirectoryResolverCallback(void *Module, std::uint32_t Ordinal, const char *Name, void **FunctionPointer);
 	void DefaultExceptionCallback(ErrorCode Code);
+	const wchar_t *GetErrorLibraryName();
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+	std::size_t BypassImportTables();
+#endif // DLL_PROXY_IMPORT_TABLE_BYPASS
+
+#if defined(DLL_PROXY_MEMORY_LIBRARY_LOADER)
+	void *LoadLibraryFromMemory(const void *Image, std::size_t Size);
+	void *MemoryLibraryResolverCallback(const wchar_t *LibraryName);
+#endif // DLL_PROXY_MEMORY_LIBRARY_LOADER
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+	const InitReport *GetInitReport();
+#endif // DLL_PROXY_ENABLE_INIT_REPORT
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+	std::size_t QueryCollapsedExports(CollapsedExport *Exports, std::size_t Capacity);
+#endif // DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+
+#if defined(DLL_PROXY_ENABLE_CALL_STATS)
+	std::size_t QueryCallStatistics(CallStatistics *Statistics, std::size_t Capacity);
+	bool WriteCallStatistics(const wchar_t *FilePath);
+#endif // DLL_PROXY_ENABLE_CALL_STATS
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+	bool WriteTraceDump(const wchar_t *FilePath);
+#endif // DLL_PROXY_ENABLE_CALL_TRACING
 }
 
 #endif // !DLLPROXY_H_DEDUP
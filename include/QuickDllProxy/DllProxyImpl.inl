@@ -1,6 +1,18 @@
+#include <array>
+#include <cstddef>
 #include <type_traits>
+#include <utility>
 #include <windows.h>
 
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+#include <psapi.h>
+#endif
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+#include <intrin.h>
+#include "DllProxyTrace.h"
+#endif
+
 #if !__cpp_constexpr || !__cpp_constinit || !__cpp_concepts
 #error This file requires a compiler with with C++20 support or newer for constexpr, constinit, and concept features.
 #endif
@@ -18,12 +30,84 @@
 #endif
 
 #if !defined(DLL_PROXY_LIBRARY_RESOLVER_CALLBACK)
+#if defined(DLL_PROXY_MEMORY_LIBRARY_LOADER)
+#define DLL_PROXY_LIBRARY_RESOLVER_CALLBACK DllProxy::MemoryLibraryResolverCallback
+#else
 #define DLL_PROXY_LIBRARY_RESOLVER_CALLBACK DllProxy::DefaultLibraryResolverCallback
 #endif
+#endif
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) && defined(DLL_PROXY_EXPORT_RESOLVER_CALLBACK)
+#error DLL_PROXY_EXPORT_DIRECTORY_RESOLVER replaces the export resolver callback. Only one of them can be defined.
+#endif
+
+#if defined(DLL_PROXY_BACKGROUND_WARMUP) && !defined(DLL_PROXY_DEFERRED_LIBRARY_LOAD)
+#define DLL_PROXY_DEFERRED_LIBRARY_LOAD
+#endif
+
+#if defined(DLL_PROXY_DEFERRED_LIBRARY_LOAD) && !defined(DLL_PROXY_LAZY_BINDING)
+#define DLL_PROXY_LAZY_BINDING
+#endif
+
+#if defined(DLL_PROXY_COLLAPSE_IMPORT_THUNKS) && !defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+#define DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+#endif
+
+#if defined(DLL_PROXY_LAZY_BINDING) && defined(DLL_PROXY_CHECK_MISSING_EXPORTS)
+#error DLL_PROXY_LAZY_BINDING resolves exports on first call. DLL_PROXY_CHECK_MISSING_EXPORTS can't be used with it.
+#endif
+
+#if defined(DLL_PROXY_ENABLE_CALL_STATS) && defined(DLL_PROXY_LAZY_BINDING)
+#error DLL_PROXY_ENABLE_CALL_STATS is only implemented for eagerly bound stubs. It can't be used with DLL_PROXY_LAZY_BINDING.
+#endif
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING) && (defined(DLL_PROXY_LAZY_BINDING) || defined(DLL_PROXY_ENABLE_CALL_STATS))
+#error DLL_PROXY_ENABLE_CALL_TRACING uses its own stubs. It can't be used with DLL_PROXY_LAZY_BINDING or DLL_PROXY_ENABLE_CALL_STATS.
+#endif
+
+#if defined(DLL_PROXY_DIRECT_JUMP_PATCHING) && (defined(DLL_PROXY_LAZY_BINDING) || defined(DLL_PROXY_ENABLE_CALL_STATS) || defined(DLL_PROXY_ENABLE_CALL_TRACING))
+#error DLL_PROXY_DIRECT_JUMP_PATCHING only applies to the default stubs. It can't be used with lazy binding, call stats, or call tracing.
+#endif
+
+#if defined(DLL_PROXY_READ_ONLY_STUBS) && (defined(DLL_PROXY_LAZY_BINDING) || defined(DLL_PROXY_ENABLE_CALL_STATS) || defined(DLL_PROXY_ENABLE_CALL_TRACING) || defined(DLL_PROXY_DIRECT_JUMP_PATCHING))
+#error DLL_PROXY_READ_ONLY_STUBS never writes to code. It can't be used with lazy binding, call stats, call tracing, or direct jump patching.
+#endif
+
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && (defined(DLL_PROXY_LAZY_BINDING) || defined(DLL_PROXY_ENABLE_CALL_STATS) || defined(DLL_PROXY_ENABLE_CALL_TRACING) || defined(DLL_PROXY_READ_ONLY_STUBS))
+#error DLL_PROXY_POSITION_INDEPENDENT_STUBS only applies to the default stubs. It can't be used with lazy binding, call stats, call tracing, or read-only stubs.
+#endif
+
+#if defined(DLL_PROXY_MEMORY_LIBRARY_LOADER) && defined(DLL_PROXY_DEFERRED_LIBRARY_LOAD)
+#error DLL_PROXY_MEMORY_LIBRARY_LOADER maps each image once during DllProxy::Initialize. It can't be used with DLL_PROXY_DEFERRED_LIBRARY_LOAD.
+#endif
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH) && defined(DLL_PROXY_LAZY_BINDING)
+#error DLL_PROXY_RESOLUTION_CACHE_PATH is only used during eager initialization. It can't be used with DLL_PROXY_LAZY_BINDING.
+#endif
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS) && (defined(DLL_PROXY_LAZY_BINDING) || defined(DLL_PROXY_ENABLE_CALL_STATS) || defined(DLL_PROXY_ENABLE_CALL_TRACING))
+#error DLL_PROXY_IMPORT_TABLE_BYPASS needs stubs that are resolved during initialization and don't observe calls. It can't be used with lazy binding, call stats, or call tracing.
+#endif
+
+#if defined(DLL_PROXY_TRACE_DUMP_PATH) && !defined(DLL_PROXY_ENABLE_CALL_TRACING)
+#error DLL_PROXY_TRACE_DUMP_PATH requires DLL_PROXY_ENABLE_CALL_TRACING.
+#endif
+
+#if defined(DLL_PROXY_CALL_STATS_DUMP_PATH) && !defined(DLL_PROXY_ENABLE_CALL_STATS)
+#error DLL_PROXY_CALL_STATS_DUMP_PATH requires DLL_PROXY_ENABLE_CALL_STATS.
+#endif
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING) && !defined(DLL_PROXY_TRACE_RECORDS_PER_THREAD)
+#define DLL_PROXY_TRACE_RECORDS_PER_THREAD 16384
+#endif
 
 #if !defined(DLL_PROXY_EXPORT_RESOLVER_CALLBACK)
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) || defined(DLL_PROXY_MEMORY_LIBRARY_LOADER)
+#define DLL_PROXY_EXPORT_RESOLVER_CALLBACK DllProxy::ExportDirectoryResolverCallback
+#else
 #define DLL_PROXY_EXPORT_RESOLVER_CALLBACK DllProxy::DefaultExportResolverCallback
 #endif
+#endif
 
 #if !defined(DLL_PROXY_EXCEPTION_CALLBACK)
 #define DLL_PROXY_EXCEPTION_CALLBACK DllProxy::DefaultExceptionCallback
@@ -39,6 +123,13 @@
 #define DLL_PROXY_ALIAS_SYMBOL(From, To)			__pragma(comment(linker, "/ALTERNATENAME:" To "=" From))
 #define DLL_PROXY_EXPORT_SYMBOL(From, To)			__pragma(comment(linker, "/EXPORT:" To "=" From))
 #define DLL_PROXY_EXPORT_ORDINAL(From, To, Ordinal) __pragma(comment(linker, "/EXPORT:" To "=" From ",@" #Ordinal))
+#define DLL_PROXY_EXPORT_FORWARDER(Name, Target)	__pragma(comment(linker, "/EXPORT:" Name "=" Target))
+#define DLL_PROXY_EXPORT_FORWARDER_ORDINAL(Name, Target, Ordinal) __pragma(comment(linker, "/EXPORT:" Name "=" Target ",@" #Ordinal))
+#define DLL_PROXY_EXPORT_ORDINAL_RANGE_MACRO
+// Every /EXPORT needs its own literal string and the preprocessor can't count. Listings written with
+// --ordinal-ranges spell ranges out one ordinal per line for MSVC.
+#define DLL_PROXY_EXPORT_ORDINAL_RANGE(From, FirstOrdinal, LastOrdinal, Stride) \
+	static_assert(false, "DECLARE_PROXIED_API_ORDINAL_RANGE requires a GNU toolchain. Declare each ordinal on its own line for MSVC.");
 #elif defined(__GNUC__) // _MSC_VER
 #define DLL_PROXY_MAKE_SECTION(Name)				__asm__(".pushsection \"" Name "\", \"xr\"\n.balign 4096\n.popsection\n");
 #define DLL_PROXY_USE_SECTION(Name)					__attribute__((section(Name), used))
@@ -48,15 +139,43 @@
 #else
 #define DLL_PROXY_SYMBOL_PREFIX ""
 #endif
-#define DLL_PROXY_EXPORT_SYMBOL(From, To)			DLL_PROXY_ALIAS_SYMBOL(From, DLL_PROXY_SYMBOL_PREFIX To)
-#define DLL_PROXY_EXPORT_ORDINAL(From, To, Ordinal) DLL_PROXY_ALIAS_SYMBOL(From, DLL_PROXY_SYMBOL_PREFIX To)
+// Exports are listed in .drectve the same way __declspec(dllexport) does it. Relying on auto-export instead breaks as
+// soon as anything in the DLL is explicitly exported, forwarders included.
+#define DLL_PROXY_EXPORT_DIRECTIVE(Directive)		__asm__(".pushsection .drectve\n.ascii \" -export:" Directive "\"\n.popsection\n");
+#define DLL_PROXY_EXPORT_SYMBOL(From, To)			DLL_PROXY_ALIAS_SYMBOL(From, DLL_PROXY_SYMBOL_PREFIX To) DLL_PROXY_EXPORT_DIRECTIVE("\\\"" To "\\\"")
+// GNU ld takes the ordinal after a space. It rejects the ",@N" form link.exe and lld use.
+#define DLL_PROXY_EXPORT_ORDINAL(From, To, Ordinal) DLL_PROXY_ALIAS_SYMBOL(From, DLL_PROXY_SYMBOL_PREFIX To) DLL_PROXY_EXPORT_DIRECTIVE("\\\"" To "\\\" @" #Ordinal)
+#define DLL_PROXY_EXPORT_FORWARDER(Name, Target)	DLL_PROXY_EXPORT_DIRECTIVE(Name "=" Target)
+#define DLL_PROXY_EXPORT_FORWARDER_ORDINAL(Name, Target, Ordinal) DLL_PROXY_EXPORT_DIRECTIVE(Name "=" Target " @" #Ordinal)
+// Ordinal ranges are exported by the assembler. A .rept loop defines one "Ordinal_N" symbol per stub in the range and
+// exports it at ordinal N, the same way DLL_PROXY_EXPORT_ORDINAL does for a single one.
+#define DLL_PROXY_EXPORT_ORDINAL_RANGE_MACRO										\
+	__asm__(".macro dllproxy_export_ordinal ordinal, from, first, stride\n"		\
+		".global \"" DLL_PROXY_SYMBOL_PREFIX "Ordinal_\\ordinal\"\n"				\
+		".set \"" DLL_PROXY_SYMBOL_PREFIX "Ordinal_\\ordinal\", \\from + (\\ordinal - \\first) * \\stride\n" \
+		".pushsection .drectve\n.ascii \" -export:\\\"Ordinal_\\ordinal\\\" @\\ordinal\"\n.popsection\n"	\
+		".endm\n");
+#define DLL_PROXY_EXPORT_ORDINAL_RANGE(From, FirstOrdinal, LastOrdinal, Stride)	\
+	__asm__(".altmacro\n.set dllproxy_ordinal, " DLL_PROXY_STRINGIFY(FirstOrdinal) "\n" \
+		".rept " DLL_PROXY_STRINGIFY(LastOrdinal) " - " DLL_PROXY_STRINGIFY(FirstOrdinal) " + 1\n" \
+		"dllproxy_export_ordinal %dllproxy_ordinal, " From ", " DLL_PROXY_STRINGIFY(FirstOrdinal) ", " DLL_PROXY_STRINGIFY(Stride) "\n" \
+		".set dllproxy_ordinal, dllproxy_ordinal + 1\n.endr\n.noaltmacro\n");
 #else // __GNUC__
 #error Unsupported compiler.
 #endif
 
 namespace DllProxy::Internal
 {
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && defined(__GNUC__)
+	// Named for Section::XPROXY_UnresolvedExportThunk, which reaches it from assembler
+	void UnresolvedExportCallback() __asm__(DLL_PROXY_SYMBOL_PREFIX "XPROXY_UnresolvedExportCallback");
+#else
 	void UnresolvedExportCallback();
+#endif
+	void *__cdecl LazyResolveStub(void *Stub);
+	void *__cdecl TraceEnter(void *Stub, void **ReturnSlot);
+	void *__cdecl TraceLeave(void **StackPointer);
+	void ShutdownTracing();
 	void WINAPI TLSInitCallback(PVOID DllHandle, DWORD Reason, PVOID Reserved);
 }
 
@@ -81,7 +200,206 @@ namespace DllProxy::Section
 	//
 	DLL_PROXY_MAKE_SECTION(".dllprox$b")
 
+#if defined(DLL_PROXY_ENABLE_CALL_STATS)
+	constexpr size_t CallCounterAlign = 64;
+	constexpr size_t CountingFuncAlign = 32;
+
+	// One counter per cache line so hot exports called from different cores don't contend over the same line. These
+	// live in regular writable data. Only the stubs reference them.
+	struct alignas(CallCounterAlign) CallCounter
+	{
+#if defined(_M_IX86)
+		volatile uint32_t CountLow;
+		volatile uint32_t CountHigh;
+#else
+		volatile uint64_t Count;
+#endif
+	};
+#endif // DLL_PROXY_ENABLE_CALL_STATS
+
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+	constexpr size_t ReadOnlyFuncAlign = 4;
+#endif
+
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && defined(__GNUC__)
+	// Position independent stubs jump here until they're resolved. The assembler fills in the rel32 displacements
+	// of both the stubs and this thunk, so none of them need a base relocation.
+	#pragma pack(push, 1)
+	struct UnresolvedExportThunkCode
+	{
+		uint8_t JmpRel32Opcode;			// 0xE9
+		int32_t JmpRel32Displacement;	// Distance to Internal::UnresolvedExportCallback
+		uint8_t Padding[11];			// 0xCC ...
+	};
+#pragma pack(pop)
+
+	extern "C" UnresolvedExportThunkCode XPROXY_UnresolvedExportThunk;
+	__asm__(".pushsection \".dllprox$b\"\n.balign 16\n"
+		".global " DLL_PROXY_SYMBOL_PREFIX "XPROXY_UnresolvedExportThunk\n" DLL_PROXY_SYMBOL_PREFIX "XPROXY_UnresolvedExportThunk:\n"
+		".byte 0xE9\n.long " DLL_PROXY_SYMBOL_PREFIX "XPROXY_UnresolvedExportCallback - . - 4\n.fill 11, 1, 0xCC\n.popsection\n");
+#elif defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) // DLL_PROXY_POSITION_INDEPENDENT_STUBS && __GNUC__
+	// MSVC can't express the distance to a shared thunk in a constant. Its position independent stubs fail fast in
+	// place until they're resolved instead: xor ecx, ecx; mov cl, UnresolvedExportFastFailCode; int 0x29. The bytes
+	// are the same on x86 and x64. The process ends with STATUS_STACK_BUFFER_OVERRUN and the code as the exception's
+	// first parameter, without going through DLL_PROXY_EXCEPTION_CALLBACK.
+	constexpr uint8_t UnresolvedExportFastFailCode = 0xD9;
+
+	#define MAKE_PROXY_UNRESOLVED_FAST_FAIL_IMPL 0x31, 0xC9, 0xB1, UnresolvedExportFastFailCode, 0xCD, 0x29
+
+	constexpr uint8_t UnresolvedExportFastFail[] = { MAKE_PROXY_UNRESOLVED_FAST_FAIL_IMPL };
+#else // DLL_PROXY_POSITION_INDEPENDENT_STUBS
+	// Ranges are built by constexpr functions, which can't cast Internal::UnresolvedExportCallback to a data pointer.
+	// Their stubs jump here until they're resolved.
+	#pragma pack(push, 1)
+	struct UnresolvedExportThunkCode
+	{
+		uint8_t JmpOpcode[2];		// 0xFF 0x25
+#if defined(_M_IX86)
+		void *JmpDwordEipAddress;	// &JmpDestination
+#else
+		int32_t JmpQwordRipOffset;	// 0x00000000
+#endif
+		void *JmpDestination;		// &Internal::UnresolvedExportCallback
+	};
+#pragma pack(pop)
+
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit UnresolvedExportThunkCode XPROXY_UnresolvedExportThunk
+	{
+		{ 0xFF, 0x25 },
+#if defined(_M_IX86)
+		&XPROXY_UnresolvedExportThunk.JmpDestination,
+#else
+		0,
+#endif
+		(void *)&Internal::UnresolvedExportCallback,
+	};
+#endif // !DLL_PROXY_POSITION_INDEPENDENT_STUBS
+
+	// DECLARE_PROXIED_API_ORDINAL_RANGE declares all of its stubs as one array. Each stub variant below provides a
+	// MakeStubRange that fills it with the same code MAKE_PROXY_EXPORT_IMPL emits for a single stub.
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+	template<size_t Count>
+	constexpr std::array<void *, Count> MakeUnresolvedDestinations()
+	{
+		std::array<void *, Count> destinations {};
+
+		for (auto& destination : destinations)
+			destination = &XPROXY_UnresolvedExportThunk;
+
+		return destinations;
+	}
+#endif // DLL_PROXY_READ_ONLY_STUBS
+
 #if defined(_M_IX86)
+#if !defined(DLL_PROXY_LAZY_BINDING) && !defined(DLL_PROXY_ENABLE_CALL_STATS) && !defined(DLL_PROXY_ENABLE_CALL_TRACING)
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+
+	// The destination lives in writable data next to the other stubs' destinations. Stub pages are never written
+	// so they stay shared between processes.
+	#pragma pack(push, 1)
+	struct X86ReadOnlyStubPlaceholderCode
+	{
+		uint8_t JmpDwordOpcode[2];	// 0xFF 0x25
+		void **JmpDwordEipAddress;	// &XPROXYPTR_
+		uint8_t Padding[2];			// 0xCC 0xCC
+	};
+	static_assert(sizeof(X86ReadOnlyStubPlaceholderCode) == 8, "Opcodes are expected to be 8 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = X86ReadOnlyStubPlaceholderCode;
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		constinit void *DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = (void *)&Internal::UnresolvedExportCallback; \
+		extern "C"									\
+		alignas(ReadOnlyFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		X86ReadOnlyStubPlaceholderCode PlaceholderName { 0xFF, 0x25, &DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName), 0xCC, 0xCC }; \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+	template<size_t Count>
+	constexpr std::array<X86ReadOnlyStubPlaceholderCode, Count> MakeStubRange(std::array<void *, Count>& Destinations)
+	{
+		std::array<X86ReadOnlyStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x25, &Destinations[i], 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		constinit std::array<void *, Count> DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = MakeUnresolvedDestinations<Count>(); \
+		extern "C"									\
+		alignas(ReadOnlyFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86ReadOnlyStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName)); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+#elif defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) // DLL_PROXY_READ_ONLY_STUBS
+
+	// A single jmp rel32 without any absolute address, so the image carries no base relocation for the stub. GNU
+	// builds have the assembler point it at XPROXY_UnresolvedExportThunk. MSVC builds start out with a displacement of
+	// 0, which lands on the fail fast sequence at the start of the padding until DllProxy::Initialize writes the real
+	// one.
+	#pragma pack(push, 1)
+	struct X86RelativeStubPlaceholderCode
+	{
+		uint8_t JmpRel32Opcode;			// 0xE9
+		int32_t JmpRel32Displacement;	// Distance to XPROXY_UnresolvedExportThunk, or 0x00000000
+		uint8_t Padding[11];			// UnresolvedExportFastFail on MSVC, then 0xCC ...
+	};
+	static_assert(sizeof(X86RelativeStubPlaceholderCode) == 16, "Opcodes are expected to be 16 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = X86RelativeStubPlaceholderCode;
+
+#if defined(__GNUC__)
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C" X86RelativeStubPlaceholderCode PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 16\n.global _" #PlaceholderName "\n_" #PlaceholderName ":\n" \
+			".byte 0xE9\n.long _XPROXY_UnresolvedExportThunk - . - 4\n.fill 11, 1, 0xCC\n.popsection\n"); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C" std::array<X86RelativeStubPlaceholderCode, Count> PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 16\n.global _" #PlaceholderName "\n_" #PlaceholderName ":\n" \
+			".rept " DLL_PROXY_STRINGIFY(Count) "\n" \
+			".byte 0xE9\n.long _XPROXY_UnresolvedExportThunk - . - 4\n.fill 11, 1, 0xCC\n.endr\n.popsection\n"); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+#else // __GNUC__
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(DefaultFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		X86RelativeStubPlaceholderCode PlaceholderName { 0xE9, 0, MAKE_PROXY_UNRESOLVED_FAST_FAIL_IMPL, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC }; \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+	template<size_t Count>
+	constexpr std::array<X86RelativeStubPlaceholderCode, Count> MakeStubRange()
+	{
+		std::array<X86RelativeStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xE9, 0, MAKE_PROXY_UNRESOLVED_FAST_FAIL_IMPL, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(DefaultFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86RelativeStubPlaceholderCode, Count> PlaceholderName = MakeStubRange<Count>(); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+#endif // __GNUC__
+
+#else // DLL_PROXY_POSITION_INDEPENDENT_STUBS
 	
 	#pragma pack(push, 1)
 	struct X86StubPlaceholderCode
@@ -94,7 +412,9 @@ namespace DllProxy::Section
 	static_assert(sizeof(X86StubPlaceholderCode) == 16, "Opcodes are expected to be 16 bytes");
 #pragma pack(pop)
 
-	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName)	\
+	using StubPlaceholderCode = X86StubPlaceholderCode;
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
 		extern "C"									\
 		alignas(DefaultFuncAlign)					\
 		DLL_PROXY_USE_SECTION(".dllprox$b")			\
@@ -102,267 +422,3713 @@ namespace DllProxy::Section
 		X86StubPlaceholderCode PlaceholderName { 0xFF, 0x25, &PlaceholderName.JmpDwordDestination, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC , 0xCC, 0xCC , 0xCC, 0xCC }; \
 		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
 
-#elif defined(_M_X64) // _M_IX86
-	
+	template<size_t Count>
+	constexpr std::array<X86StubPlaceholderCode, Count> MakeStubRange(std::array<X86StubPlaceholderCode, Count>& Stubs)
+	{
+		std::array<X86StubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x25, &Stubs[i].JmpDwordDestination, &XPROXY_UnresolvedExportThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(DefaultFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86StubPlaceholderCode, Count> PlaceholderName = MakeStubRange(PlaceholderName); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+#endif // DLL_PROXY_POSITION_INDEPENDENT_STUBS
+
+#elif defined(DLL_PROXY_ENABLE_CALL_STATS) // !DLL_PROXY_LAZY_BINDING && !DLL_PROXY_ENABLE_CALL_STATS && !DLL_PROXY_ENABLE_CALL_TRACING
+
 	#pragma pack(push, 1)
-	struct Amd64StubPlaceholderCode
+	struct X86CountingStubPlaceholderCode
 	{
-		uint8_t JmpQwordOpcode[2]; // 0xFF 0x25
-		int32_t JmpQwordRipOffset; // 0x00000000
-		void *JmpQwordDestination; // 0xDEADC0DEDEADC0DE
-		uint8_t Padding[2];		   // 0xCC 0xCC
+		uint8_t LockAddOpcode[3];		  // 0xF0 0x83 0x05			lock add dword ptr [CountLow], 1
+		volatile uint32_t *CountLow;	  // &CallCounter->CountLow
+		uint8_t LockAddImmediate;		  // 0x01
+		uint8_t LockAdcOpcode[3];		  // 0xF0 0x83 0x15			lock adc dword ptr [CountHigh], 0
+		volatile uint32_t *CountHigh;	  // &CallCounter->CountHigh
+		uint8_t LockAdcImmediate;		  // 0x00
+		uint8_t JmpDwordOpcode[2];		  // 0xFF 0x25				jmp dword ptr [JmpDwordDestination]
+		void *JmpDwordEipAddress;		  // &JmpDwordDestination
+		void *JmpDwordDestination;		  // 0xDEADC0DE
+		uint8_t Padding[6];				  // 0xCC ...
 	};
-	static_assert(sizeof(Amd64StubPlaceholderCode) == 16, "Opcodes are expected to be 16 bytes");
+	static_assert(sizeof(X86CountingStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
 #pragma pack(pop)
 
-	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName)	\
+	using StubPlaceholderCode = X86CountingStubPlaceholderCode;
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		alignas(CallCounterAlign) constinit CallCounter DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName) {}; \
 		extern "C"									\
-		alignas(DefaultFuncAlign)					\
+		alignas(CountingFuncAlign)					\
 		DLL_PROXY_USE_SECTION(".dllprox$b")			\
 		constinit									\
-		Amd64StubPlaceholderCode PlaceholderName { 0xFF, 0x25, 0, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC };
-
-#endif // _M_X64
+		X86CountingStubPlaceholderCode PlaceholderName { 0xF0, 0x83, 0x05, &DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName).CountLow, 0x01, 0xF0, 0x83, 0x15, &DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName).CountHigh, 0x00, 0xFF, 0x25, &PlaceholderName.JmpDwordDestination, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC }; \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
 
-#define MAKE_PROXY_API_IMPL(FuncName, VariableAlias) \
-	MAKE_PROXY_EXPORT_IMPL(VariableAlias)            \
-	DLL_PROXY_EXPORT_SYMBOL(DLL_PROXY_STRINGIFY(VariableAlias), FuncName)
+	template<size_t Count>
+	constexpr std::array<X86CountingStubPlaceholderCode, Count> MakeStubRange(std::array<CallCounter, Count>& Counters, std::array<X86CountingStubPlaceholderCode, Count>& Stubs)
+	{
+		std::array<X86CountingStubPlaceholderCode, Count> range {};
 
-#define MAKE_PROXY_API_ORDINAL_IMPL(FuncName, Ordinal, VariableAlias) \
-	MAKE_PROXY_EXPORT_IMPL(VariableAlias)                             \
-	DLL_PROXY_EXPORT_ORDINAL(DLL_PROXY_STRINGIFY(VariableAlias), FuncName, Ordinal)
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xF0, 0x83, 0x05, &Counters[i].CountLow, 0x01, 0xF0, 0x83, 0x15, &Counters[i].CountHigh, 0x00, 0xFF, 0x25, &Stubs[i].JmpDwordDestination, &XPROXY_UnresolvedExportThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
 
-#define DECLARE_PROXIED_API(FuncName) \
-	MAKE_PROXY_API_IMPL(FuncName, DLL_PROXY_CONCAT(XPROXY_, __COUNTER__))
+		return range;
+	}
 
-#define DECLARE_PROXIED_API_ORDINAL(FuncName, Ordinal) \
-	MAKE_PROXY_API_ORDINAL_IMPL(FuncName, Ordinal, DLL_PROXY_CONCAT(XPROXY_, __COUNTER__))
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		alignas(CallCounterAlign) constinit std::array<CallCounter, Count> DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName) {}; \
+		extern "C"									\
+		alignas(CountingFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86CountingStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName), PlaceholderName); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
 
-#define DECLARE_PROXIED_LIBRARY(LibraryName) \
-	constexpr auto OriginalLibraryName = L##LibraryName;
+#elif defined(DLL_PROXY_ENABLE_CALL_TRACING) // DLL_PROXY_ENABLE_CALL_STATS
 
-#include DLL_PROXY_EXPORT_LISTING_FILE
+	constexpr size_t TraceFuncAlign = 32;
 
-#undef DECLARE_PROXIED_LIBRARY
-#undef DECLARE_PROXIED_API_ORDINAL
-#undef DECLARE_PROXIED_API
-#undef MAKE_PROXY_API_ORDINAL_IMPL
-#undef MAKE_PROXY_API_IMPL
-#undef MAKE_PROXY_EXPORT_IMPL
+	#pragma pack(push, 1)
+	struct X86TraceStubPlaceholderCode
+	{
+		uint8_t CallDwordOpcode[2]; // 0xFF 0x15				call dword ptr [TraceThunk]
+		void *CallDwordAddress;		// &TraceThunk
+		uint32_t ExportIndex;		// Return address of the call above. Index into Section::ExportTable.
+		void *TraceThunk;			// &XPROXY_TraceEnterThunk
+		void *JmpDwordDestination;	// 0xDEADC0DE. Read by Internal::TraceEnter instead of being jumped through.
+		uint8_t Padding[14];		// 0xCC ...
+	};
+	static_assert(sizeof(X86TraceStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
+	static_assert(offsetof(X86TraceStubPlaceholderCode, ExportIndex) == 6, "Thunk expects ExportIndex at offset 6");
 
-	//
-	// .dllprox$z - End of the segment
-	//
-	DLL_PROXY_MAKE_SECTION(".dllprox$z")
-	alignas(DefaultPageAlign) DLL_PROXY_USE_SECTION(".dllprox$z") constinit uint8_t ExportBoundaryEnd = 1;
+	// Shared by every trace stub. Preserves ecx, edx, and xmm0-xmm5, passes the stub and the caller's return address
+	// slot to Internal::TraceEnter, and tail jumps to the real function it returns.
+	struct X86TraceEnterThunkCode
+	{
+		uint8_t Prologue[35];		// pop eax; push ecx; push edx; sub esp, 0x60; movups [esp+N], xmm0-xmm5
+		uint8_t PushArgsOpcode[9];	// lea ecx, [esp+0x68]; push ecx; lea ecx, [eax-0x6]; push ecx
+		uint8_t CallDwordOpcode[2]; // 0xFF 0x15				call dword ptr [TraceFunction]
+		void *CallDwordAddress;		// &TraceFunction
+		uint8_t Epilogue[42];		// add esp, 8; movups xmm0-xmm5, [esp+N]; add esp, 0x60; pop edx; pop ecx; jmp eax
+		void *TraceFunction;		// &Internal::TraceEnter
+	};
+	static_assert(sizeof(X86TraceEnterThunkCode) == 96, "Opcodes are expected to be 96 bytes");
 
-	//
-	// Merge ".dllprox" into ".text" with identical attributes
-	//
-#if defined(_MSC_VER)
-	#pragma comment(linker, "/MERGE:.dllprox=.text")
-#endif
-}
+	// Traced calls return here instead of to their caller. Preserves eax, edx, and xmm0-xmm3 (return values), passes
+	// the stack pointer the traced call returned with to Internal::TraceLeave, and jumps to the original return address
+	// it hands back.
+	struct X86TraceLeaveThunkCode
+	{
+		uint8_t Prologue[24];		// push eax; push edx; sub esp, 0x40; movups [esp+N], xmm0-xmm3
+		uint8_t PushArgsOpcode[5];	// lea ecx, [esp+0x48]; push ecx
+		uint8_t CallDwordOpcode[2]; // 0xFF 0x15				call dword ptr [TraceFunction]
+		void *CallDwordAddress;		// &TraceFunction
+		uint8_t Epilogue[33];		// add esp, 4; mov ecx, eax; movups xmm0-xmm3, [esp+N]; add esp, 0x40; pop edx; pop eax; jmp ecx
+		void *TraceFunction;		// &Internal::TraceLeave
+	};
+	static_assert(sizeof(X86TraceLeaveThunkCode) == 72, "Opcodes are expected to be 72 bytes");
+#pragma pack(pop)
 
-//
-// ----------------------------------------------------------------
-// -         Thread local storage callback implementation         -
-// ----------------------------------------------------------------
-//
-namespace DllProxy::TLS
-{
-#if defined(DLL_PROXY_TLS_CALLBACK_AUTOINIT)
-#if defined(_MSC_VER)
-#if defined(_M_IX86)
+	using StubPlaceholderCode = X86TraceStubPlaceholderCode;
 
-	#pragma data_seg(push, proxdata, ".CRT$XLB")
-	extern "C" PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
-	#pragma data_seg(pop, proxdata)
-	#pragma comment(linker, "/INCLUDE:__tls_used")
-	#pragma comment(linker, "/INCLUDE:_DllProxyTLSCallback")
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit X86TraceEnterThunkCode XPROXY_TraceEnterThunk
+	{
+		{
+			0x58,											// pop eax
+			0x51,											// push ecx
+			0x52,											// push edx
+			0x83, 0xEC, 0x60,								// sub esp, 0x60
+			0x0F, 0x11, 0x04, 0x24,							// movups [esp], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x10,					// movups [esp+0x10], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x20,					// movups [esp+0x20], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x30,					// movups [esp+0x30], xmm3
+			0x0F, 0x11, 0x64, 0x24, 0x40,					// movups [esp+0x40], xmm4
+			0x0F, 0x11, 0x6C, 0x24, 0x50,					// movups [esp+0x50], xmm5
+		},
+		{
+			0x8D, 0x4C, 0x24, 0x68,							// lea ecx, [esp+0x68]
+			0x51,											// push ecx
+			0x8D, 0x48, 0xFA,								// lea ecx, [eax-0x6]
+			0x51,											// push ecx
+		},
+		{ 0xFF, 0x15 },
+		&XPROXY_TraceEnterThunk.TraceFunction,
+		{
+			0x83, 0xC4, 0x08,								// add esp, 8
+			0x0F, 0x10, 0x04, 0x24,							// movups xmm0, [esp]
+			0x0F, 0x10, 0x4C, 0x24, 0x10,					// movups xmm1, [esp+0x10]
+			0x0F, 0x10, 0x54, 0x24, 0x20,					// movups xmm2, [esp+0x20]
+			0x0F, 0x10, 0x5C, 0x24, 0x30,					// movups xmm3, [esp+0x30]
+			0x0F, 0x10, 0x64, 0x24, 0x40,					// movups xmm4, [esp+0x40]
+			0x0F, 0x10, 0x6C, 0x24, 0x50,					// movups xmm5, [esp+0x50]
+			0x83, 0xC4, 0x60,								// add esp, 0x60
+			0x5A,											// pop edx
+			0x59,											// pop ecx
+			0xFF, 0xE0,										// jmp eax
+			0xCC, 0xCC, 0xCC,
+		},
+		(void *)&Internal::TraceEnter,
+	};
 
-#elif defined(_M_X64) // _M_IX86
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit X86TraceLeaveThunkCode XPROXY_TraceLeaveThunk
+	{
+		{
+			0x50,											// push eax
+			0x52,											// push edx
+			0x83, 0xEC, 0x40,								// sub esp, 0x40
+			0x0F, 0x11, 0x04, 0x24,							// movups [esp], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x10,					// movups [esp+0x10], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x20,					// movups [esp+0x20], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x30,					// movups [esp+0x30], xmm3
+		},
+		{
+			0x8D, 0x4C, 0x24, 0x48,							// lea ecx, [esp+0x48]
+			0x51,											// push ecx
+		},
+		{ 0xFF, 0x15 },
+		&XPROXY_TraceLeaveThunk.TraceFunction,
+		{
+			0x83, 0xC4, 0x04,								// add esp, 4
+			0x89, 0xC1,										// mov ecx, eax
+			0x0F, 0x10, 0x04, 0x24,							// movups xmm0, [esp]
+			0x0F, 0x10, 0x4C, 0x24, 0x10,					// movups xmm1, [esp+0x10]
+			0x0F, 0x10, 0x54, 0x24, 0x20,					// movups xmm2, [esp+0x20]
+			0x0F, 0x10, 0x5C, 0x24, 0x30,					// movups xmm3, [esp+0x30]
+			0x83, 0xC4, 0x40,								// add esp, 0x40
+			0x5A,											// pop edx
+			0x58,											// pop eax
+			0xFF, 0xE1,										// jmp ecx
+			0xCC, 0xCC,
+		},
+		(void *)&Internal::TraceLeave,
+	};
 
-	#pragma const_seg(push, proxconst, ".CRT$XLB")
-	extern "C" constexpr PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
-	#pragma const_seg(pop, proxconst)
-	#pragma comment(linker, "/INCLUDE:_tls_used")
-	#pragma comment(linker, "/INCLUDE:DllProxyTLSCallback")
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(TraceFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		X86TraceStubPlaceholderCode PlaceholderName { 0xFF, 0x15, &PlaceholderName.TraceThunk, (Index), &XPROXY_TraceEnterThunk, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC }; \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
 
-#endif // _M_X64
-#elif defined(__GNUC__) // _MSC_VER
-#if defined(_M_IX86)
+	template<size_t Count>
+	constexpr std::array<X86TraceStubPlaceholderCode, Count> MakeStubRange(std::array<X86TraceStubPlaceholderCode, Count>& Stubs, uint32_t FirstIndex)
+	{
+		std::array<X86TraceStubPlaceholderCode, Count> range {};
 
-	DLL_PROXY_USE_SECTION(".CRT$XLB") extern "C" PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x15, &Stubs[i].TraceThunk, FirstIndex + i, &XPROXY_TraceEnterThunk, &XPROXY_UnresolvedExportThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
 
-#elif defined(_M_X64) // _M_IX86
+		return range;
+	}
 
-	DLL_PROXY_USE_SECTION(".CRT$XLB") extern "C" constexpr PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(TraceFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86TraceStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(PlaceholderName, FirstIndex); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
 
-#endif // _M_X64
-#endif // __GNUC__
-#endif // DLL_PROXY_TLS_CALLBACK_AUTOINIT
-}
+#else // DLL_PROXY_ENABLE_CALL_TRACING
 
-//
-// ----------------------------------------------------------------
-// -            Runtime export resolver implementation            -
-// ----------------------------------------------------------------
-//
-namespace DllProxy::Internal
-{
-	constexpr PfnRealLibraryResolver RealLibraryResolver = ::DLL_PROXY_LIBRARY_RESOLVER_CALLBACK;
-	constexpr PfnRealExportResolver RealExportResolver = ::DLL_PROXY_EXPORT_RESOLVER_CALLBACK;
-	constexpr PfnExceptionCallback ExceptionCallback = ::DLL_PROXY_EXCEPTION_CALLBACK;
+	constexpr size_t LazyFuncAlign = 32;
 
-	void InitializeImpl();
+	#pragma pack(push, 1)
+	struct X86LazyStubPlaceholderCode
+	{
+		uint8_t JmpDwordOpcode[2];	// 0xFF 0x25				jmp dword ptr [JmpDwordDestination]
+		void *JmpDwordEipAddress;	// &JmpDwordDestination
+		void *JmpDwordDestination;	// &CallDwordOpcode until resolved
+		uint8_t CallDwordOpcode[2]; // 0xFF 0x15				call dword ptr [ResolverThunk]
+		void *CallDwordAddress;		// &ResolverThunk
+		uint32_t ExportIndex;		// Return address of the call above. Index into Section::ExportTable.
+		void *ResolverThunk;		// &XPROXY_LazyResolverThunk
+		uint8_t Padding[8];			// 0xCC ...
+	};
+	static_assert(sizeof(X86LazyStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
+	static_assert(offsetof(X86LazyStubPlaceholderCode, ExportIndex) == 16, "Thunk expects ExportIndex at offset 16");
+
+	// Shared by every lazy stub. Preserves ecx, edx, and xmm0-xmm5 (fastcall/thiscall/vectorcall arguments), asks
+	// Internal::LazyResolveStub for the real function, and tail jumps to it.
+	struct X86LazyResolverThunkCode
+	{
+		uint8_t Prologue[35];		// pop eax; push ecx; push edx; sub esp, 0x60; movups [esp+N], xmm0-xmm5
+		uint8_t PushStubOpcode[4];	// lea ecx, [eax-0x10]; push ecx
+		uint8_t CallDwordOpcode[2]; // 0xFF 0x15				call dword ptr [ResolverFunction]
+		void *CallDwordAddress;		// &ResolverFunction
+		uint8_t Epilogue[39];		// add esp, 4; movups xmm0-xmm5, [esp+N]; add esp, 0x60; pop edx; pop ecx; jmp eax
+		void *ResolverFunction;		// &Internal::LazyResolveStub
+	};
+	static_assert(sizeof(X86LazyResolverThunkCode) == 88, "Opcodes are expected to be 88 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = X86LazyStubPlaceholderCode;
+
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit X86LazyResolverThunkCode XPROXY_LazyResolverThunk
+	{
+		{
+			0x58,											// pop eax
+			0x51,											// push ecx
+			0x52,											// push edx
+			0x83, 0xEC, 0x60,								// sub esp, 0x60
+			0x0F, 0x11, 0x04, 0x24,							// movups [esp], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x10,					// movups [esp+0x10], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x20,					// movups [esp+0x20], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x30,					// movups [esp+0x30], xmm3
+			0x0F, 0x11, 0x64, 0x24, 0x40,					// movups [esp+0x40], xmm4
+			0x0F, 0x11, 0x6C, 0x24, 0x50,					// movups [esp+0x50], xmm5
+		},
+		{ 0x8D, 0x48, 0xF0, 0x51 },							// lea ecx, [eax-0x10]; push ecx
+		{ 0xFF, 0x15 },
+		&XPROXY_LazyResolverThunk.ResolverFunction,
+		{
+			0x83, 0xC4, 0x04,								// add esp, 4
+			0x0F, 0x10, 0x04, 0x24,							// movups xmm0, [esp]
+			0x0F, 0x10, 0x4C, 0x24, 0x10,					// movups xmm1, [esp+0x10]
+			0x0F, 0x10, 0x54, 0x24, 0x20,					// movups xmm2, [esp+0x20]
+			0x0F, 0x10, 0x5C, 0x24, 0x30,					// movups xmm3, [esp+0x30]
+			0x0F, 0x10, 0x64, 0x24, 0x40,					// movups xmm4, [esp+0x40]
+			0x0F, 0x10, 0x6C, 0x24, 0x50,					// movups xmm5, [esp+0x50]
+			0x83, 0xC4, 0x60,								// add esp, 0x60
+			0x5A,											// pop edx
+			0x59,											// pop ecx
+			0xFF, 0xE0,										// jmp eax
+		},
+		(void *)&Internal::LazyResolveStub,
+	};
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(LazyFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		X86LazyStubPlaceholderCode PlaceholderName { 0xFF, 0x25, &PlaceholderName.JmpDwordDestination, &PlaceholderName.CallDwordOpcode, 0xFF, 0x15, &PlaceholderName.ResolverThunk, (Index), &XPROXY_LazyResolverThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC }; \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+	template<size_t Count>
+	constexpr std::array<X86LazyStubPlaceholderCode, Count> MakeStubRange(std::array<X86LazyStubPlaceholderCode, Count>& Stubs, uint32_t FirstIndex)
+	{
+		std::array<X86LazyStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x25, &Stubs[i].JmpDwordDestination, &Stubs[i].CallDwordOpcode, 0xFF, 0x15, &Stubs[i].ResolverThunk, FirstIndex + i, &XPROXY_LazyResolverThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(LazyFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<X86LazyStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(PlaceholderName, FirstIndex); \
+		DLL_PROXY_ALIAS_SYMBOL(DLL_PROXY_STRINGIFY(_##PlaceholderName), #PlaceholderName)
+
+#endif // DLL_PROXY_LAZY_BINDING
+#elif defined(_M_X64) // _M_IX86
+#if !defined(DLL_PROXY_LAZY_BINDING) && !defined(DLL_PROXY_ENABLE_CALL_STATS) && !defined(DLL_PROXY_ENABLE_CALL_TRACING)
+#if defined(DLL_PROXY_READ_ONLY_STUBS) && defined(__GNUC__)
+
+	// jmp qword ptr [rip+disp32] straight into the stub's pointer slot, so no register is touched and the stub carries
+	// no absolute address. constinit can't produce the distance between two objects. The assembler emits the stubs
+	// instead and the linker fills in each displacement without leaving a base relocation behind.
+	#pragma pack(push, 1)
+	struct Amd64ReadOnlyStubPlaceholderCode
+	{
+		uint8_t JmpQwordOpcode[2];	 // 0xFF 0x25
+		int32_t JmpQwordRipOffset;	 // Distance to XPROXYPTR_
+		uint8_t Padding[2];			 // 0xCC 0xCC
+	};
+	static_assert(sizeof(Amd64ReadOnlyStubPlaceholderCode) == 8, "Opcodes are expected to be 8 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64ReadOnlyStubPlaceholderCode;
+
+	// Raw bytes instead of a mnemonic so the stubs assemble the same under -masm=intel
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C" __attribute__((used)) constinit void *DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = (void *)&Internal::UnresolvedExportCallback; \
+		extern "C" Amd64ReadOnlyStubPlaceholderCode PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 4\n.global " #PlaceholderName "\n" #PlaceholderName ":\n" \
+			".byte 0xFF, 0x25\n.long XPROXYPTR_" #PlaceholderName " - . - 4\n.byte 0xCC, 0xCC\n.popsection\n");
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C" __attribute__((used)) constinit std::array<void *, Count> DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = MakeUnresolvedDestinations<Count>(); \
+		extern "C" std::array<Amd64ReadOnlyStubPlaceholderCode, Count> PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 4\n.global " #PlaceholderName "\n" #PlaceholderName ":\n" \
+			".set dllproxy_slot, 0\n.rept " DLL_PROXY_STRINGIFY(Count) "\n" \
+			".byte 0xFF, 0x25\n.long XPROXYPTR_" #PlaceholderName " + dllproxy_slot - . - 4\n.byte 0xCC, 0xCC\n" \
+			".set dllproxy_slot, dllproxy_slot + 8\n.endr\n.popsection\n");
+
+#elif defined(DLL_PROXY_READ_ONLY_STUBS) // DLL_PROXY_READ_ONLY_STUBS && __GNUC__
+
+	// MSVC has no x64 inline assembler to emit the rip-relative form above, and constinit can't produce the distance
+	// to the destination. The absolute address goes through rax instead. It's volatile and never carries arguments.
+	#pragma pack(push, 1)
+	struct Amd64ReadOnlyStubPlaceholderCode
+	{
+		uint8_t MovRaxOpcode[2];	 // 0x48 0xB8
+		void **MovRaxDestination;	 // &XPROXYPTR_
+		uint8_t JmpRaxOpcode[2];	 // 0xFF 0x20
+	};
+	static_assert(sizeof(Amd64ReadOnlyStubPlaceholderCode) == 12, "Opcodes are expected to be 12 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64ReadOnlyStubPlaceholderCode;
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		constinit void *DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = (void *)&Internal::UnresolvedExportCallback; \
+		extern "C"									\
+		alignas(ReadOnlyFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		Amd64ReadOnlyStubPlaceholderCode PlaceholderName { 0x48, 0xB8, &DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName), 0xFF, 0x20 };
+
+	template<size_t Count>
+	constexpr std::array<Amd64ReadOnlyStubPlaceholderCode, Count> MakeStubRange(std::array<void *, Count>& Destinations)
+	{
+		std::array<Amd64ReadOnlyStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0x48, 0xB8, &Destinations[i], 0xFF, 0x20 };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		constinit std::array<void *, Count> DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName) = MakeUnresolvedDestinations<Count>(); \
+		extern "C"									\
+		alignas(ReadOnlyFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<Amd64ReadOnlyStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(DLL_PROXY_CONCAT(XPROXYPTR_, PlaceholderName));
+
+#else // DLL_PROXY_READ_ONLY_STUBS
 	
-	__declspec(noinline) void UnrecoverableError(ErrorCode Code)
+	#pragma pack(push, 1)
+	struct Amd64StubPlaceholderCode
 	{
-		ExceptionCallback(Code);
+		uint8_t JmpQwordOpcode[2]; // 0xFF 0x25
+		int32_t JmpQwordRipOffset; // 0x00000000
+		void *JmpQwordDestination; // 0xDEADC0DEDEADC0DE
+		uint8_t Padding[2];		   // 0xCC 0xCC
+	};
+	static_assert(sizeof(Amd64StubPlaceholderCode) == 16, "Opcodes are expected to be 16 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64StubPlaceholderCode;
+
+	// The RIP-relative jump needs no relocation, only the absolute destination does. Position independent stubs
+	// built by GNU toolchains start out as a jmp rel32 to XPROXY_UnresolvedExportThunk in place of the indirect
+	// jump, with a null destination behind it. MSVC builds start out with UnresolvedExportFastFail there instead. It
+	// fits in front of the destination exactly. Writing the destination puts the indirect jump back in either case.
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && defined(__GNUC__)
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C" Amd64StubPlaceholderCode PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 16\n.global " #PlaceholderName "\n" #PlaceholderName ":\n" \
+			".byte 0xE9\n.long XPROXY_UnresolvedExportThunk - . - 4\n.byte 0xCC\n.quad 0\n.byte 0xCC, 0xCC\n.popsection\n");
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C" std::array<Amd64StubPlaceholderCode, Count> PlaceholderName; \
+		__asm__(".pushsection \".dllprox$b\"\n.balign 16\n.global " #PlaceholderName "\n" #PlaceholderName ":\n" \
+			".rept " DLL_PROXY_STRINGIFY(Count) "\n" \
+			".byte 0xE9\n.long XPROXY_UnresolvedExportThunk - . - 4\n.byte 0xCC\n.quad 0\n.byte 0xCC, 0xCC\n.endr\n.popsection\n");
+
+#else // DLL_PROXY_POSITION_INDEPENDENT_STUBS && __GNUC__
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS)
+	constexpr int32_t UnresolvedExportFastFailRipOffset = UnresolvedExportFastFail[2] | (UnresolvedExportFastFail[3] << 8) |
+		(UnresolvedExportFastFail[4] << 16) | (UnresolvedExportFastFail[5] << 24);
+
+	#define MAKE_PROXY_UNRESOLVED_JMP_IMPL UnresolvedExportFastFail[0], UnresolvedExportFastFail[1], UnresolvedExportFastFailRipOffset
+	#define MAKE_PROXY_UNRESOLVED_DESTINATION_IMPL nullptr
+	#define MAKE_PROXY_UNRESOLVED_RANGE_DESTINATION_IMPL nullptr
+#else
+	#define MAKE_PROXY_UNRESOLVED_JMP_IMPL 0xFF, 0x25, 0
+	#define MAKE_PROXY_UNRESOLVED_DESTINATION_IMPL (void *)&Internal::UnresolvedExportCallback
+	#define MAKE_PROXY_UNRESOLVED_RANGE_DESTINATION_IMPL &XPROXY_UnresolvedExportThunk
+#endif
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(DefaultFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		Amd64StubPlaceholderCode PlaceholderName { MAKE_PROXY_UNRESOLVED_JMP_IMPL, MAKE_PROXY_UNRESOLVED_DESTINATION_IMPL, 0xCC, 0xCC };
+
+	template<size_t Count>
+	constexpr std::array<Amd64StubPlaceholderCode, Count> MakeStubRange()
+	{
+		std::array<Amd64StubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { MAKE_PROXY_UNRESOLVED_JMP_IMPL, MAKE_PROXY_UNRESOLVED_RANGE_DESTINATION_IMPL, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(DefaultFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<Amd64StubPlaceholderCode, Count> PlaceholderName = MakeStubRange<Count>();
+
+#endif // DLL_PROXY_POSITION_INDEPENDENT_STUBS && __GNUC__
+#endif // DLL_PROXY_READ_ONLY_STUBS
+
+#elif defined(DLL_PROXY_ENABLE_CALL_STATS) // !DLL_PROXY_LAZY_BINDING && !DLL_PROXY_ENABLE_CALL_STATS && !DLL_PROXY_ENABLE_CALL_TRACING
+
+	#pragma pack(push, 1)
+	struct Amd64CountingStubPlaceholderCode
+	{
+		uint8_t MovRaxOpcode[2];	// 0x48 0xB8				mov rax, CallCounter
+		CallCounter *Counter;		// &CallCounter
+		uint8_t LockIncOpcode[4];	// 0xF0 0x48 0xFF 0x00		lock inc qword ptr [rax]
+		uint8_t JmpQwordOpcode[2];	// 0xFF 0x25				jmp qword ptr [rip+0]
+		int32_t JmpQwordRipOffset;	// 0x00000000
+		void *JmpQwordDestination;	// 0xDEADC0DEDEADC0DE
+		uint8_t Padding[4];			// 0xCC ...
+	};
+	static_assert(sizeof(Amd64CountingStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64CountingStubPlaceholderCode;
+
+	// rax is volatile and never holds an argument, so the prologue is free to clobber it
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		alignas(CallCounterAlign) constinit CallCounter DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName) {}; \
+		extern "C"									\
+		alignas(CountingFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		Amd64CountingStubPlaceholderCode PlaceholderName { 0x48, 0xB8, &DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName), 0xF0, 0x48, 0xFF, 0x00, 0xFF, 0x25, 0, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC, 0xCC, 0xCC };
+
+	template<size_t Count>
+	constexpr std::array<Amd64CountingStubPlaceholderCode, Count> MakeStubRange(std::array<CallCounter, Count>& Counters)
+	{
+		std::array<Amd64CountingStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0x48, 0xB8, &Counters[i], 0xF0, 0x48, 0xFF, 0x00, 0xFF, 0x25, 0, &XPROXY_UnresolvedExportThunk, 0xCC, 0xCC, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		alignas(CallCounterAlign) constinit std::array<CallCounter, Count> DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName) {}; \
+		extern "C"									\
+		alignas(CountingFuncAlign)					\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<Amd64CountingStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(DLL_PROXY_CONCAT(CALLCOUNT_, PlaceholderName));
+
+#elif defined(DLL_PROXY_ENABLE_CALL_TRACING) // DLL_PROXY_ENABLE_CALL_STATS
+
+	constexpr size_t TraceFuncAlign = 32;
+
+	#pragma pack(push, 1)
+	struct Amd64TraceStubPlaceholderCode
+	{
+		uint8_t CallQwordOpcode[2]; // 0xFF 0x15				call qword ptr [rip+4]
+		int32_t CallQwordRipOffset; // 0x00000004
+		uint32_t ExportIndex;		// Return address of the call above. Index into Section::ExportTable.
+		void *TraceThunk;			// &XPROXY_TraceEnterThunk
+		void *JmpQwordDestination;	// 0xDEADC0DEDEADC0DE. Read by Internal::TraceEnter instead of being jumped through.
+		uint8_t Padding[6];			// 0xCC ...
+	};
+	static_assert(sizeof(Amd64TraceStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
+	static_assert(offsetof(Amd64TraceStubPlaceholderCode, ExportIndex) == 6, "Thunk expects ExportIndex at offset 6");
+
+	// Shared by every trace stub. Preserves rcx, rdx, r8, r9, and xmm0-xmm5, passes the stub and the caller's return
+	// address slot to Internal::TraceEnter, and tail jumps to the real function it returns.
+	struct Amd64TraceEnterThunkCode
+	{
+		uint8_t Prologue[44];		 // pop rax; push rcx/rdx/r8/r9; sub rsp, 0x88; movups [rsp+N], xmm0-xmm5
+		uint8_t LoadArgsOpcode[12];	 // lea rcx, [rax-0x6]; lea rdx, [rsp+0xA8]
+		uint8_t CallQwordOpcode[2];	 // 0xFF 0x15				call qword ptr [rip+CallQwordRipOffset]
+		int32_t CallQwordRipOffset;	 // Distance to TraceFunction
+		uint8_t Epilogue[50];		 // movups xmm0-xmm5, [rsp+N]; add rsp, 0x88; pop r9/r8/rdx/rcx; jmp rax; int3 padding
+		void *TraceFunction;		 // &Internal::TraceEnter
+	};
+	static_assert(sizeof(Amd64TraceEnterThunkCode) == 120, "Opcodes are expected to be 120 bytes");
+
+	// Traced calls return here instead of to their caller. Preserves rax and xmm0-xmm3 (return values, including
+	// vectorcall HVAs), passes the stack pointer the traced call returned with to Internal::TraceLeave, and jumps to
+	// the original return address it hands back through r11.
+	struct Amd64TraceLeaveThunkCode
+	{
+		uint8_t Prologue[25];		 // push rax; sub rsp, 0x68; movups [rsp+N], xmm0-xmm3
+		uint8_t LoadArgsOpcode[5];	 // lea rcx, [rsp+0x70]
+		uint8_t CallQwordOpcode[2];	 // 0xFF 0x15				call qword ptr [rip+CallQwordRipOffset]
+		int32_t CallQwordRipOffset;	 // Distance to TraceFunction
+		uint8_t Epilogue[36];		 // mov r11, rax; movups xmm0-xmm3, [rsp+N]; add rsp, 0x68; pop rax; jmp r11; int3 padding
+		void *TraceFunction;		 // &Internal::TraceLeave
+	};
+	static_assert(sizeof(Amd64TraceLeaveThunkCode) == 80, "Opcodes are expected to be 80 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64TraceStubPlaceholderCode;
+
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit Amd64TraceEnterThunkCode XPROXY_TraceEnterThunk
+	{
+		{
+			0x58,											// pop rax
+			0x51,											// push rcx
+			0x52,											// push rdx
+			0x41, 0x50,										// push r8
+			0x41, 0x51,										// push r9
+			0x48, 0x81, 0xEC, 0x88, 0x00, 0x00, 0x00,		// sub rsp, 0x88
+			0x0F, 0x11, 0x44, 0x24, 0x20,					// movups [rsp+0x20], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x30,					// movups [rsp+0x30], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x40,					// movups [rsp+0x40], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x50,					// movups [rsp+0x50], xmm3
+			0x0F, 0x11, 0x64, 0x24, 0x60,					// movups [rsp+0x60], xmm4
+			0x0F, 0x11, 0x6C, 0x24, 0x70,					// movups [rsp+0x70], xmm5
+		},
+		{
+			0x48, 0x8D, 0x48, 0xFA,							// lea rcx, [rax-0x6]
+			0x48, 0x8D, 0x94, 0x24, 0xA8, 0x00, 0x00, 0x00,	// lea rdx, [rsp+0xA8]
+		},
+		{ 0xFF, 0x15 },
+		static_cast<int32_t>(offsetof(Amd64TraceEnterThunkCode, TraceFunction) - offsetof(Amd64TraceEnterThunkCode, Epilogue)),
+		{
+			0x0F, 0x10, 0x44, 0x24, 0x20,					// movups xmm0, [rsp+0x20]
+			0x0F, 0x10, 0x4C, 0x24, 0x30,					// movups xmm1, [rsp+0x30]
+			0x0F, 0x10, 0x54, 0x24, 0x40,					// movups xmm2, [rsp+0x40]
+			0x0F, 0x10, 0x5C, 0x24, 0x50,					// movups xmm3, [rsp+0x50]
+			0x0F, 0x10, 0x64, 0x24, 0x60,					// movups xmm4, [rsp+0x60]
+			0x0F, 0x10, 0x6C, 0x24, 0x70,					// movups xmm5, [rsp+0x70]
+			0x48, 0x81, 0xC4, 0x88, 0x00, 0x00, 0x00,		// add rsp, 0x88
+			0x41, 0x59,										// pop r9
+			0x41, 0x58,										// pop r8
+			0x5A,											// pop rdx
+			0x59,											// pop rcx
+			0xFF, 0xE0,										// jmp rax
+			0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+		},
+		(void *)&Internal::TraceEnter,
+	};
+
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit Amd64TraceLeaveThunkCode XPROXY_TraceLeaveThunk
+	{
+		{
+			0x50,											// push rax
+			0x48, 0x83, 0xEC, 0x68,							// sub rsp, 0x68
+			0x0F, 0x11, 0x44, 0x24, 0x20,					// movups [rsp+0x20], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x30,					// movups [rsp+0x30], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x40,					// movups [rsp+0x40], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x50,					// movups [rsp+0x50], xmm3
+		},
+		{
+			0x48, 0x8D, 0x4C, 0x24, 0x70,					// lea rcx, [rsp+0x70]
+		},
+		{ 0xFF, 0x15 },
+		static_cast<int32_t>(offsetof(Amd64TraceLeaveThunkCode, TraceFunction) - offsetof(Amd64TraceLeaveThunkCode, Epilogue)),
+		{
+			0x49, 0x89, 0xC3,								// mov r11, rax
+			0x0F, 0x10, 0x44, 0x24, 0x20,					// movups xmm0, [rsp+0x20]
+			0x0F, 0x10, 0x4C, 0x24, 0x30,					// movups xmm1, [rsp+0x30]
+			0x0F, 0x10, 0x54, 0x24, 0x40,					// movups xmm2, [rsp+0x40]
+			0x0F, 0x10, 0x5C, 0x24, 0x50,					// movups xmm3, [rsp+0x50]
+			0x48, 0x83, 0xC4, 0x68,							// add rsp, 0x68
+			0x58,											// pop rax
+			0x41, 0xFF, 0xE3,								// jmp r11
+			0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+		},
+		(void *)&Internal::TraceLeave,
+	};
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(TraceFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		Amd64TraceStubPlaceholderCode PlaceholderName { 0xFF, 0x15, 4, (Index), &XPROXY_TraceEnterThunk, (void *)&Internal::UnresolvedExportCallback, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+
+	template<size_t Count>
+	constexpr std::array<Amd64TraceStubPlaceholderCode, Count> MakeStubRange(uint32_t FirstIndex)
+	{
+		std::array<Amd64TraceStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x15, 4, FirstIndex + i, &XPROXY_TraceEnterThunk, &XPROXY_UnresolvedExportThunk, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(TraceFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<Amd64TraceStubPlaceholderCode, Count> PlaceholderName = MakeStubRange<Count>(FirstIndex);
+
+#else // DLL_PROXY_ENABLE_CALL_TRACING
+
+	constexpr size_t LazyFuncAlign = 32;
+
+	#pragma pack(push, 1)
+	struct Amd64LazyStubPlaceholderCode
+	{
+		uint8_t JmpQwordOpcode[2];	// 0xFF 0x25				jmp qword ptr [rip+0]
+		int32_t JmpQwordRipOffset;	// 0x00000000
+		void *JmpQwordDestination;	// &CallQwordOpcode until resolved
+		uint8_t CallQwordOpcode[2]; // 0xFF 0x15				call qword ptr [rip+4]
+		int32_t CallQwordRipOffset; // 0x00000004
+		uint32_t ExportIndex;		// Return address of the call above. Index into Section::ExportTable.
+		void *ResolverThunk;		// &XPROXY_LazyResolverThunk
+	};
+	static_assert(sizeof(Amd64LazyStubPlaceholderCode) == 32, "Opcodes are expected to be 32 bytes");
+	static_assert(offsetof(Amd64LazyStubPlaceholderCode, ExportIndex) == 20, "Thunk expects ExportIndex at offset 20");
+
+	// Shared by every lazy stub. Preserves rcx, rdx, r8, r9, and xmm0-xmm5 (including vectorcall arguments), asks
+	// Internal::LazyResolveStub for the real function, and tail jumps to it. rax is volatile and never an argument.
+	struct Amd64LazyResolverThunkCode
+	{
+		uint8_t Prologue[44];		 // pop rax; push rcx/rdx/r8/r9; sub rsp, 0x88; movups [rsp+N], xmm0-xmm5
+		uint8_t LoadStubOpcode[4];	 // lea rcx, [rax-0x14]
+		uint8_t CallQwordOpcode[2];	 // 0xFF 0x15				call qword ptr [rip+CallQwordRipOffset]
+		int32_t CallQwordRipOffset;	 // Distance to ResolverFunction
+		uint8_t Epilogue[50];		 // movups xmm0-xmm5, [rsp+N]; add rsp, 0x88; pop r9/r8/rdx/rcx; jmp rax; int3 padding
+		void *ResolverFunction;		 // &Internal::LazyResolveStub
+	};
+	static_assert(sizeof(Amd64LazyResolverThunkCode) == 112, "Opcodes are expected to be 112 bytes");
+#pragma pack(pop)
+
+	using StubPlaceholderCode = Amd64LazyStubPlaceholderCode;
+
+	DLL_PROXY_MAKE_SECTION(".dllprox$b")
+	extern "C" alignas(DefaultFuncAlign) DLL_PROXY_USE_SECTION(".dllprox$b") constinit Amd64LazyResolverThunkCode XPROXY_LazyResolverThunk
+	{
+		{
+			0x58,											// pop rax
+			0x51,											// push rcx
+			0x52,											// push rdx
+			0x41, 0x50,										// push r8
+			0x41, 0x51,										// push r9
+			0x48, 0x81, 0xEC, 0x88, 0x00, 0x00, 0x00,		// sub rsp, 0x88
+			0x0F, 0x11, 0x44, 0x24, 0x20,					// movups [rsp+0x20], xmm0
+			0x0F, 0x11, 0x4C, 0x24, 0x30,					// movups [rsp+0x30], xmm1
+			0x0F, 0x11, 0x54, 0x24, 0x40,					// movups [rsp+0x40], xmm2
+			0x0F, 0x11, 0x5C, 0x24, 0x50,					// movups [rsp+0x50], xmm3
+			0x0F, 0x11, 0x64, 0x24, 0x60,					// movups [rsp+0x60], xmm4
+			0x0F, 0x11, 0x6C, 0x24, 0x70,					// movups [rsp+0x70], xmm5
+		},
+		{ 0x48, 0x8D, 0x48, 0xEC },							// lea rcx, [rax-0x14]
+		{ 0xFF, 0x15 },
+		static_cast<int32_t>(offsetof(Amd64LazyResolverThunkCode, ResolverFunction) - offsetof(Amd64LazyResolverThunkCode, Epilogue)),
+		{
+			0x0F, 0x10, 0x44, 0x24, 0x20,					// movups xmm0, [rsp+0x20]
+			0x0F, 0x10, 0x4C, 0x24, 0x30,					// movups xmm1, [rsp+0x30]
+			0x0F, 0x10, 0x54, 0x24, 0x40,					// movups xmm2, [rsp+0x40]
+			0x0F, 0x10, 0x5C, 0x24, 0x50,					// movups xmm3, [rsp+0x50]
+			0x0F, 0x10, 0x64, 0x24, 0x60,					// movups xmm4, [rsp+0x60]
+			0x0F, 0x10, 0x6C, 0x24, 0x70,					// movups xmm5, [rsp+0x70]
+			0x48, 0x81, 0xC4, 0x88, 0x00, 0x00, 0x00,		// add rsp, 0x88
+			0x41, 0x59,										// pop r9
+			0x41, 0x58,										// pop r8
+			0x5A,											// pop rdx
+			0x59,											// pop rcx
+			0xFF, 0xE0,										// jmp rax
+			0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+		},
+		(void *)&Internal::LazyResolveStub,
+	};
+
+	#define MAKE_PROXY_EXPORT_IMPL(PlaceholderName, Index) \
+		extern "C"									\
+		alignas(LazyFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		Amd64LazyStubPlaceholderCode PlaceholderName { 0xFF, 0x25, 0, &PlaceholderName.CallQwordOpcode, 0xFF, 0x15, 4, (Index), &XPROXY_LazyResolverThunk };
+
+	template<size_t Count>
+	constexpr std::array<Amd64LazyStubPlaceholderCode, Count> MakeStubRange(std::array<Amd64LazyStubPlaceholderCode, Count>& Stubs, uint32_t FirstIndex)
+	{
+		std::array<Amd64LazyStubPlaceholderCode, Count> range {};
+
+		for (uint32_t i = 0; i < Count; i++)
+			range[i] = { 0xFF, 0x25, 0, &Stubs[i].CallQwordOpcode, 0xFF, 0x15, 4, FirstIndex + i, &XPROXY_LazyResolverThunk };
+
+		return range;
+	}
+
+	#define MAKE_PROXY_EXPORT_RANGE_IMPL(PlaceholderName, FirstIndex, Count) \
+		extern "C"									\
+		alignas(LazyFuncAlign)						\
+		DLL_PROXY_USE_SECTION(".dllprox$b")			\
+		constinit									\
+		std::array<Amd64LazyStubPlaceholderCode, Count> PlaceholderName = MakeStubRange(PlaceholderName, FirstIndex);
+
+#endif // DLL_PROXY_LAZY_BINDING
+#endif // _M_X64
+
+	// Stride of the stubs in a range. The assembler computes each ranged export's address from it.
+#if defined(DLL_PROXY_READ_ONLY_STUBS) && (defined(_M_IX86) || defined(__GNUC__))
+	#define MAKE_PROXY_STUB_SIZE_IMPL 8
+#elif defined(DLL_PROXY_READ_ONLY_STUBS) // DLL_PROXY_READ_ONLY_STUBS && (_M_IX86 || __GNUC__)
+	#define MAKE_PROXY_STUB_SIZE_IMPL 12
+#elif !defined(DLL_PROXY_LAZY_BINDING) && !defined(DLL_PROXY_ENABLE_CALL_STATS) && !defined(DLL_PROXY_ENABLE_CALL_TRACING) // DLL_PROXY_READ_ONLY_STUBS
+	#define MAKE_PROXY_STUB_SIZE_IMPL 16
+#else
+	#define MAKE_PROXY_STUB_SIZE_IMPL 32
+#endif
+	static_assert(sizeof(StubPlaceholderCode) == MAKE_PROXY_STUB_SIZE_IMPL, "Range stride doesn't match the stub size");
+
+	//
+	// Compile-time export and library tables. Every listing line consumes one __COUNTER__ value and specializes
+	// ListingAt<Index> with it. Lines link to the line before them and keep running totals of exports and libraries,
+	// so each one only reads its predecessor and the tables are built in a single walk back along the chain.
+	// DllProxy::Initialize walks these tables instead of parsing the module's own export directory.
+	//
+	struct ExportEntry
+	{
+		const char *Name;
+		uint32_t Ordinal; // 0 if the listing didn't specify one
+		uint32_t Library; // Index into LibraryTable
+		StubPlaceholderCode *Stub;
+	};
+
+	struct LibraryEntry
+	{
+		const wchar_t *Name;
+		uint32_t FirstExport; // Exports declared after a library belong to it until the next library
+		uint32_t ExportCount;
+	};
+
+	// Hooked exports carry a binder that publishes the real function through DllProxy::Original and returns the hook
+	// for the stub to jump to instead
+	using PfnHookBinder = void *(*)(void *RealFunction);
+
+	struct HookEntry
+	{
+		uint32_t ExportIndex;
+		PfnHookBinder Bind;
+	};
+
+	struct HookBinding
+	{
+		PfnHookBinder Bind;
+		void *Original; // &DllProxy::Original<Hook>. Read by DllProxy::Real since the stub jumps to the hook.
+	};
+
+	struct ListingLine
+	{
+		const ListingLine *Previous;	// nullptr for ListingAt<0>, the head of the chain
+		const wchar_t *LibraryName;		// Set by DECLARE_PROXIED_LIBRARY only
+		ExportEntry Entry;				// First export of the line
+		uint32_t ExportCount;			// 1, or the number of ordinals in a range
+		const HookBinding *Hook;
+		uint32_t ExportEnd;				// Exports declared up to and including this line
+		uint32_t LibraryEnd;			// Libraries declared up to and including this line
+	};
+
+	template<size_t Index>
+	constexpr ListingLine ListingAt {};
+
+	template<auto Hook>
+	void *BindHook(void *RealFunction)
+	{
+		InterlockedExchangePointer(reinterpret_cast<void **>(&Original<Hook>), RealFunction);
+		return reinterpret_cast<void *>(Hook);
+	}
+
+	template<auto Hook>
+	constexpr HookBinding HookBindingFor { &BindHook<Hook>, &Original<Hook> };
+
+	// "Ordinal_N" names of the exports in a range. They're packed at a fixed stride so the export table can find each
+	// one from the line's first name. Ranges of the same length share one instantiation of the function that builds
+	// them, which matters once a listing has thousands of ranges.
+	constexpr size_t OrdinalRangeNameStride = 16;
+
+	template<size_t Count>
+	struct OrdinalRangeNameTable
+	{
+		char Value[Count * OrdinalRangeNameStride];
+	};
+
+	template<size_t Count>
+	constexpr OrdinalRangeNameTable<Count> MakeOrdinalRangeNames(uint32_t FirstOrdinal)
+	{
+		OrdinalRangeNameTable<Count> names {};
+		const char prefix[] = "Ordinal_";
+
+		for (uint32_t i = 0; i < Count; i++)
+		{
+			const uint32_t ordinal = FirstOrdinal + i;
+			auto name = &names.Value[i * OrdinalRangeNameStride];
+
+			for (size_t j = 0; prefix[j] != '\0'; j++)
+				*name++ = prefix[j];
+
+			uint32_t divisor = 10000;
+
+			while (divisor > 1 && ordinal / divisor == 0)
+				divisor /= 10;
+
+			for (; divisor != 0; divisor /= 10)
+				*name++ = static_cast<char>('0' + ordinal / divisor % 10);
+		}
+
+		return names;
+	}
+
+	template<uint32_t FirstOrdinal, uint32_t LastOrdinal>
+	constexpr auto OrdinalRangeNames = MakeOrdinalRangeNames<LastOrdinal - FirstOrdinal + 1>(FirstOrdinal);
+
+	constexpr uint32_t ListingCounterBase = __COUNTER__;
+
+#define MAKE_PROXY_LISTING_INDEX_IMPL(Counter) \
+	((Counter) - ListingCounterBase)
+
+#define MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter) \
+	ListingAt<MAKE_PROXY_LISTING_INDEX_IMPL(Counter) - 1>
+
+#define MAKE_PROXY_EXPORT_INDEX_IMPL(Counter) \
+	(MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter).ExportEnd)
+
+#define MAKE_PROXY_TABLE_ENTRY_IMPL(FuncName, Ordinal, Count, Counter, Stub, Hook)                              \
+	static_assert(MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter).LibraryEnd != 0,                                       \
+		"DECLARE_PROXIED_LIBRARY must come before the exports that belong to it.");                             \
+	template<>                                                                                                  \
+	constexpr ListingLine ListingAt<MAKE_PROXY_LISTING_INDEX_IMPL(Counter)> {                                   \
+		&MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter), nullptr,                                                       \
+		{ FuncName, Ordinal, MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter).LibraryEnd - 1, Stub }, Count, Hook,        \
+		MAKE_PROXY_EXPORT_INDEX_IMPL(Counter) + (Count), MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter).LibraryEnd };
+
+#define MAKE_PROXY_API_IMPL(FuncName, Counter, VariableAlias, Hook)                 \
+	MAKE_PROXY_EXPORT_IMPL(VariableAlias, MAKE_PROXY_EXPORT_INDEX_IMPL(Counter))   \
+	MAKE_PROXY_TABLE_ENTRY_IMPL(FuncName, 0, 1, Counter, &VariableAlias, Hook)    \
+	DLL_PROXY_EXPORT_SYMBOL(DLL_PROXY_STRINGIFY(VariableAlias), FuncName)
+
+#define MAKE_PROXY_API_ORDINAL_IMPL(FuncName, Ordinal, Counter, VariableAlias, Hook)  \
+	MAKE_PROXY_EXPORT_IMPL(VariableAlias, MAKE_PROXY_EXPORT_INDEX_IMPL(Counter))     \
+	MAKE_PROXY_TABLE_ENTRY_IMPL(FuncName, Ordinal, 1, Counter, &VariableAlias, Hook) \
+	DLL_PROXY_EXPORT_ORDINAL(DLL_PROXY_STRINGIFY(VariableAlias), FuncName, Ordinal)
+
+#define MAKE_PROXY_API_ORDINAL_RANGE_IMPL(FirstOrdinal, LastOrdinal, Counter, VariableAlias)                      \
+	static_assert((FirstOrdinal) > 0 && (FirstOrdinal) <= (LastOrdinal) && (LastOrdinal) <= 0xFFFF,             \
+		"Ordinal ranges must be ascending and within 1-65535.");                                                \
+	MAKE_PROXY_EXPORT_RANGE_IMPL(VariableAlias, MAKE_PROXY_EXPORT_INDEX_IMPL(Counter), (LastOrdinal) - (FirstOrdinal) + 1) \
+	MAKE_PROXY_TABLE_ENTRY_IMPL((OrdinalRangeNames<FirstOrdinal, LastOrdinal>.Value), FirstOrdinal,            \
+		(LastOrdinal) - (FirstOrdinal) + 1, Counter, VariableAlias.data(), nullptr)                             \
+	DLL_PROXY_EXPORT_ORDINAL_RANGE(DLL_PROXY_STRINGIFY(VariableAlias), FirstOrdinal, LastOrdinal, MAKE_PROXY_STUB_SIZE_IMPL)
+
+#define MAKE_PROXY_LIBRARY_IMPL(LibraryName, Counter)                                                           \
+	template<>                                                                                                  \
+	constexpr ListingLine ListingAt<MAKE_PROXY_LISTING_INDEX_IMPL(Counter)> {                                   \
+		&MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter), LibraryName, {}, 0, nullptr,                                   \
+		MAKE_PROXY_EXPORT_INDEX_IMPL(Counter), MAKE_PROXY_PREVIOUS_LINE_IMPL(Counter).LibraryEnd + 1 };
+
+// Counter is expanded once here so the stub name and table index agree
+#define MAKE_PROXY_API_COUNTER_IMPL(FuncName, Counter, Hook) \
+	MAKE_PROXY_API_IMPL(FuncName, Counter, DLL_PROXY_CONCAT(XPROXY_, Counter), Hook)
+
+#define MAKE_PROXY_API_ORDINAL_COUNTER_IMPL(FuncName, Ordinal, Counter, Hook) \
+	MAKE_PROXY_API_ORDINAL_IMPL(FuncName, Ordinal, Counter, DLL_PROXY_CONCAT(XPROXY_, Counter), Hook)
+
+#define MAKE_PROXY_API_ORDINAL_RANGE_COUNTER_IMPL(FirstOrdinal, LastOrdinal, Counter) \
+	MAKE_PROXY_API_ORDINAL_RANGE_IMPL(FirstOrdinal, LastOrdinal, Counter, DLL_PROXY_CONCAT(XPROXY_, Counter))
+
+#define DECLARE_PROXIED_API(FuncName) \
+	MAKE_PROXY_API_COUNTER_IMPL(FuncName, __COUNTER__, nullptr)
+
+#define DECLARE_PROXIED_API_ORDINAL(FuncName, Ordinal) \
+	MAKE_PROXY_API_ORDINAL_COUNTER_IMPL(FuncName, Ordinal, __COUNTER__, nullptr)
+
+#define DECLARE_PROXIED_API_HOOK(FuncName, Hook) \
+	MAKE_PROXY_API_COUNTER_IMPL(FuncName, __COUNTER__, &HookBindingFor<&Hook>)
+
+#define DECLARE_PROXIED_API_ORDINAL_HOOK(FuncName, Ordinal, Hook) \
+	MAKE_PROXY_API_ORDINAL_COUNTER_IMPL(FuncName, Ordinal, __COUNTER__, &HookBindingFor<&Hook>)
+
+// One line and one stub array for a run of consecutive NONAME ordinals, exported as "Ordinal_N" like the listing
+// generator names them
+#define DECLARE_PROXIED_API_ORDINAL_RANGE(FirstOrdinal, LastOrdinal) \
+	MAKE_PROXY_API_ORDINAL_RANGE_COUNTER_IMPL(FirstOrdinal, LastOrdinal, __COUNTER__)
+
+// Forwarders are resolved by the loader. They get no stub and no table entry, so they don't consume __COUNTER__.
+#define DECLARE_FORWARDED_API(FuncName, Target) \
+	DLL_PROXY_EXPORT_FORWARDER(FuncName, Target)
+
+#define DECLARE_FORWARDED_API_ORDINAL(FuncName, Target, Ordinal) \
+	DLL_PROXY_EXPORT_FORWARDER_ORDINAL(FuncName, Target, Ordinal)
+
+#define DECLARE_PROXIED_LIBRARY(LibraryName) \
+	MAKE_PROXY_LIBRARY_IMPL(L##LibraryName, __COUNTER__)
+
+	DLL_PROXY_EXPORT_ORDINAL_RANGE_MACRO
+
+#include DLL_PROXY_EXPORT_LISTING_FILE
+
+#undef DECLARE_PROXIED_LIBRARY
+#undef DECLARE_FORWARDED_API_ORDINAL
+#undef DECLARE_FORWARDED_API
+#undef DECLARE_PROXIED_API_ORDINAL_RANGE
+#undef DECLARE_PROXIED_API_ORDINAL_HOOK
+#undef DECLARE_PROXIED_API_HOOK
+#undef DECLARE_PROXIED_API_ORDINAL
+#undef DECLARE_PROXIED_API
+#undef MAKE_PROXY_API_ORDINAL_RANGE_COUNTER_IMPL
+#undef MAKE_PROXY_API_ORDINAL_COUNTER_IMPL
+#undef MAKE_PROXY_API_COUNTER_IMPL
+#undef MAKE_PROXY_LIBRARY_IMPL
+#undef MAKE_PROXY_API_ORDINAL_RANGE_IMPL
+#undef MAKE_PROXY_API_ORDINAL_IMPL
+#undef MAKE_PROXY_API_IMPL
+#undef MAKE_PROXY_TABLE_ENTRY_IMPL
+#undef MAKE_PROXY_EXPORT_INDEX_IMPL
+#undef MAKE_PROXY_PREVIOUS_LINE_IMPL
+#undef MAKE_PROXY_LISTING_INDEX_IMPL
+#undef MAKE_PROXY_STUB_SIZE_IMPL
+#undef MAKE_PROXY_EXPORT_RANGE_IMPL
+#undef MAKE_PROXY_EXPORT_IMPL
+#undef MAKE_PROXY_UNRESOLVED_RANGE_DESTINATION_IMPL
+#undef MAKE_PROXY_UNRESOLVED_DESTINATION_IMPL
+#undef MAKE_PROXY_UNRESOLVED_JMP_IMPL
+#undef MAKE_PROXY_UNRESOLVED_FAST_FAIL_IMPL
+
+	constexpr size_t ListingCount = __COUNTER__ - ListingCounterBase - 1;
+	constexpr size_t ExportCount = ListingAt<ListingCount>.ExportEnd;
+	constexpr size_t LibraryCount = ListingAt<ListingCount>.LibraryEnd;
+
+	// A __COUNTER__ value taken by anything other than a listing line leaves an empty link that ends the walk early
+	static_assert([]()
+	{
+		size_t count = 0;
+
+		for (auto line = &ListingAt<ListingCount>; line->Previous; line = line->Previous)
+			count++;
+
+		return count == ListingCount;
+	}(), "Export table has a gap. Listing files must not use __COUNTER__.");
+
+	static_assert(LibraryCount != 0, "Listing files must declare at least one library with DECLARE_PROXIED_LIBRARY.");
+
+	struct ListingTables
+	{
+		std::array<ExportEntry, ExportCount> Exports;
+		std::array<const HookBinding *, ExportCount> Hooks;
+		std::array<LibraryEntry, LibraryCount> Libraries;
+	};
+
+	// Walks the chain from the last line back. A library's export count comes from the library after it, which has
+	// already been filled in by then.
+	constexpr ListingTables MakeListingTables()
+	{
+		ListingTables tables {};
+
+		for (auto line = &ListingAt<ListingCount>; line->Previous; line = line->Previous)
+		{
+			if (line->LibraryName)
+			{
+				const uint32_t nextFirstExport = line->LibraryEnd < LibraryCount ? tables.Libraries[line->LibraryEnd].FirstExport : ExportCount;
+				tables.Libraries[line->LibraryEnd - 1] = { line->LibraryName, line->ExportEnd, nextFirstExport - line->ExportEnd };
+				continue;
+			}
+
+			const auto& entry = line->Entry;
+
+			for (uint32_t i = 0; i < line->ExportCount; i++)
+			{
+				const uint32_t index = line->ExportEnd - line->ExportCount + i;
+
+				tables.Exports[index] = { entry.Name + i * OrdinalRangeNameStride, entry.Ordinal + i, entry.Library, entry.Stub + i };
+				tables.Hooks[index] = line->Hook;
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr auto Listing = MakeListingTables();
+	constexpr auto ExportTable = Listing.Exports;
+	constexpr auto LibraryTable = Listing.Libraries;
+
+	constexpr size_t HookCount = []()
+	{
+		size_t count = 0;
+
+		for (const auto hook : Listing.Hooks)
+			count += hook != nullptr;
+
+		return count;
+	}();
+
+	// Sorted by export index since the listing is walked in order
+	constexpr std::array<HookEntry, HookCount> MakeHookTable()
+	{
+		std::array<HookEntry, HookCount> table {};
+		size_t count = 0;
+
+		for (uint32_t i = 0; i < Listing.Hooks.size(); i++)
+		{
+			if (Listing.Hooks[i])
+				table[count++] = { i, Listing.Hooks[i]->Bind };
+		}
+
+		return table;
+	}
+
+	constexpr auto HookTable = MakeHookTable();
+
+	// Resolved while compiling DllProxy::Real. ExportCount if the listing doesn't declare Name.
+	template<ExportName Name>
+	constexpr size_t ExportIndexOf = []()
+	{
+		for (size_t i = 0; i < ExportTable.size(); i++)
+		{
+			const char *exportName = ExportTable[i].Name;
+			size_t j = 0;
+
+			while (exportName[j] == Name.Value[j] && Name.Value[j] != '\0')
+				j++;
+
+			if (exportName[j] == Name.Value[j])
+				return i;
+		}
+
+		return ExportCount;
+	}();
+
+	//
+	// .dllprox$z - End of the segment
+	//
+	DLL_PROXY_MAKE_SECTION(".dllprox$z")
+	alignas(DefaultPageAlign) DLL_PROXY_USE_SECTION(".dllprox$z") constinit uint8_t ExportBoundaryEnd = 1;
+
+	//
+	// Merge ".dllprox" into ".text" with identical attributes
+	//
+#if defined(_MSC_VER)
+	#pragma comment(linker, "/MERGE:.dllprox=.text")
+#endif
+}
+
+//
+// ----------------------------------------------------------------
+// -         Thread local storage callback implementation         -
+// ----------------------------------------------------------------
+//
+namespace DllProxy::TLS
+{
+#if defined(DLL_PROXY_TLS_CALLBACK_AUTOINIT) || defined(DLL_PROXY_TRACE_DUMP_PATH) || defined(DLL_PROXY_CALL_STATS_DUMP_PATH) || defined(DLL_PROXY_ENABLE_CALL_TRACING)
+#if defined(_MSC_VER)
+#if defined(_M_IX86)
+
+	#pragma data_seg(push, proxdata, ".CRT$XLB")
+	extern "C" PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+	#pragma data_seg(pop, proxdata)
+	#pragma comment(linker, "/INCLUDE:__tls_used")
+	#pragma comment(linker, "/INCLUDE:_DllProxyTLSCallback")
+
+#elif defined(_M_X64) // _M_IX86
+
+	#pragma const_seg(push, proxconst, ".CRT$XLB")
+	extern "C" constexpr PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+	#pragma const_seg(pop, proxconst)
+	#pragma comment(linker, "/INCLUDE:_tls_used")
+	#pragma comment(linker, "/INCLUDE:DllProxyTLSCallback")
+
+#endif // _M_X64
+#elif defined(__GNUC__) // _MSC_VER
+#if defined(_M_IX86)
+
+	DLL_PROXY_USE_SECTION(".CRT$XLB") extern "C" PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+
+#elif defined(_M_X64) // _M_IX86
+
+	DLL_PROXY_USE_SECTION(".CRT$XLB") extern "C" constexpr PIMAGE_TLS_CALLBACK DllProxyTLSCallback = Internal::TLSInitCallback;
+
+#endif // _M_X64
+#endif // __GNUC__
+#endif // DLL_PROXY_TLS_CALLBACK_AUTOINIT || DLL_PROXY_TRACE_DUMP_PATH || DLL_PROXY_CALL_STATS_DUMP_PATH || DLL_PROXY_ENABLE_CALL_TRACING
+}
+
+//
+// ----------------------------------------------------------------
+// -            Runtime export resolver implementation            -
+// ----------------------------------------------------------------
+//
+namespace DllProxy::Internal
+{
+	constexpr PfnRealExportResolver RealExportResolver = ::DLL_PROXY_EXPORT_RESOLVER_CALLBACK;
+	constexpr PfnExceptionCallback ExceptionCallback = ::DLL_PROXY_EXCEPTION_CALLBACK;
+
+	constinit const wchar_t *ErrorLibraryName = nullptr;
+
+	void InitializeImpl();
+	
+	__declspec(noinline) void UnrecoverableError(ErrorCode Code, const wchar_t *LibraryName = nullptr)
+	{
+		ErrorLibraryName = LibraryName;
+		ExceptionCallback(Code);
+
+		__debugbreak();
+#if defined(_MSC_VER)
+		__assume(0);
+#elif defined(__GNUC__)
+		__builtin_unreachable();
+#endif
+	}
+
+	void UnresolvedExportCallback()
+	{
+		UnrecoverableError(ErrorCode::ExportNotResolved);
+	}
+
+	// Ranged stubs, and position independent ones built by GNU toolchains, reach the callback through
+	// Section::XPROXY_UnresolvedExportThunk
+	bool IsUnresolvedDestination(const void *Destination)
+	{
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && !defined(__GNUC__)
+		return Destination == reinterpret_cast<void *>(&UnresolvedExportCallback);
+#else
+		return Destination == reinterpret_cast<void *>(&UnresolvedExportCallback) || Destination == &Section::XPROXY_UnresolvedExportThunk;
+#endif
+	}
+
+	// Pass the resolver as a templated type so both signatures can be accepted. Resolvers without a LibraryName
+	// parameter predate multi-library listings.
+	template<typename T>
+	void *InvokeLibraryResolver(T&& Resolver, const wchar_t *LibraryName)
+	{
+		if constexpr (std::is_invocable_r_v<void *, T, const wchar_t *>)
+		{
+			return Resolver(LibraryName);
+		}
+		else
+		{
+			static_assert(std::is_invocable_r_v<void *, T> && Section::LibraryCount == 1,
+				"Library resolvers without a LibraryName parameter can only be used with a single library.");
+
+			return Resolver();
+		}
+	}
+
+	void *ResolveOriginalLibrary(const Section::LibraryEntry& Library)
+	{
+		const auto module = InvokeLibraryResolver(::DLL_PROXY_LIBRARY_RESOLVER_CALLBACK, Library.Name);
+
+		if (!module)
+			UnrecoverableError(ErrorCode::LibraryNotFound, Library.Name);
+
+		return module;
+	}
+
+	void WINAPI TLSInitCallback(PVOID DllHandle, DWORD Reason, PVOID Reserved)
+	{
+#if defined(DLL_PROXY_TLS_CALLBACK_AUTOINIT)
+		if (Reason == DLL_PROCESS_ATTACH)
+			InitializeImpl();
+#endif
+
+#if defined(DLL_PROXY_TRACE_DUMP_PATH)
+		if (Reason == DLL_PROCESS_DETACH)
+			DllProxy::WriteTraceDump(DLL_PROXY_TRACE_DUMP_PATH);
+#endif
+
+#if defined(DLL_PROXY_CALL_STATS_DUMP_PATH)
+		if (Reason == DLL_PROCESS_DETACH)
+			DllProxy::WriteCallStatistics(DLL_PROXY_CALL_STATS_DUMP_PATH);
+#endif
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+		if (Reason == DLL_PROCESS_DETACH)
+			ShutdownTracing();
+#endif
+	}
+
+	__declspec(noinline) void *GetLocalModuleHandle()
+	{
+		constinit static void *moduleHandle = nullptr;
+
+		if (!moduleHandle)
+		{
+			uint32_t flags = GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT;
+			HMODULE handle = nullptr;
+
+			if (!GetModuleHandleExW(flags, reinterpret_cast<LPCWSTR>(&GetLocalModuleHandle), &handle))
+				UnrecoverableError(ErrorCode::InvalidModuleBase);
+
+			InterlockedExchangePointer(&moduleHandle, handle);
+		}
+
+		return moduleHandle;
+	}
+
+	//
+	// Read-only view over a loaded module's export directory. Used to resolve exports without GetProcAddress.
+	//
+	struct ExportDirectoryView
+	{
+		uintptr_t ModuleBase = 0;
+		const IMAGE_EXPORT_DIRECTORY *Directory = nullptr;
+		uint32_t DirectoryStart = 0; // Function RVAs inside [DirectoryStart, DirectoryEnd) are forwarder strings
+		uint32_t DirectoryEnd = 0;
+		const uint32_t *Functions = nullptr;
+		const uint32_t *Names = nullptr;
+		const uint16_t *NameOrdinals = nullptr;
+	};
+
+	constexpr uint32_t InvalidFunctionIndex = 0xFFFFFFFF;
+	constexpr uint32_t MaxForwarderDepth = 16;
+
+	void *ResolveExportFunction(const ExportDirectoryView& View, uint32_t FunctionIndex, uint32_t& Depth);
+
+	bool GetExportDirectoryView(const void *Module, ExportDirectoryView& View)
+	{
+		if (!Module)
+			return false;
+
+		const auto moduleBase = reinterpret_cast<uintptr_t>(Module);
+		auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(moduleBase);
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+			return false;
+
+		auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(moduleBase + dosHeader->e_lfanew);
+
+		if (ntHeaders->Signature != IMAGE_NT_SIGNATURE ||
+			ntHeaders->FileHeader.SizeOfOptionalHeader < sizeof(IMAGE_OPTIONAL_HEADER))
+			return false;
+
+		auto exportDataDirectory = &ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+
+		if (exportDataDirectory->VirtualAddress == 0 || exportDataDirectory->Size <= 0)
+			return false;
+
+		auto exportDirectory = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY *>(moduleBase + exportDataDirectory->VirtualAddress);
+
+		View.ModuleBase = moduleBase;
+		View.Directory = exportDirectory;
+		View.DirectoryStart = exportDataDirectory->VirtualAddress;
+		View.DirectoryEnd = exportDataDirectory->VirtualAddress + exportDataDirectory->Size;
+		View.Functions = reinterpret_cast<const uint32_t *>(moduleBase + exportDirectory->AddressOfFunctions);
+		View.Names = reinterpret_cast<const uint32_t *>(moduleBase + exportDirectory->AddressOfNames);
+		View.NameOrdinals = reinterpret_cast<const uint16_t *>(moduleBase + exportDirectory->AddressOfNameOrdinals);
+		return true;
+	}
+
+	// Byte-wise comparison matching the order of the export name table. strcmp isn't available without the CRT.
+	int CompareExportNames(const char *A, const char *B)
+	{
+		auto a = reinterpret_cast<const uint8_t *>(A);
+		auto b = reinterpret_cast<const uint8_t *>(B);
+
+		while (*a && *a == *b)
+		{
+			a++;
+			b++;
+		}
+
+		return static_cast<int>(*a) - static_cast<int>(*b);
+	}
+
+	uint32_t FindExportFunctionIndex(const ExportDirectoryView& View, uint32_t Ordinal, const char *Name)
+	{
+		// Names are sorted so a binary search works. Ordinals are just an index.
+		if (Name)
+		{
+			uint32_t low = 0;
+			uint32_t high = View.Directory->NumberOfNames;
+
+			while (low < high)
+			{
+				const uint32_t middle = low + (high - low) / 2;
+				const int result = CompareExportNames(Name, reinterpret_cast<const char *>(View.ModuleBase + View.Names[middle]));
+
+				// A corrupt name ordinal table must not index past the function table
+				if (result == 0)
+					return View.NameOrdinals[middle] < View.Directory->NumberOfFunctions ? View.NameOrdinals[middle] : InvalidFunctionIndex;
+
+				if (result < 0)
+					high = middle;
+				else
+					low = middle + 1;
+			}
+		}
+
+		// Ordinal 0 means no ordinal, even for directories whose Base is 0
+		if (Ordinal != 0 && Ordinal >= View.Directory->Base && Ordinal - View.Directory->Base < View.Directory->NumberOfFunctions)
+			return Ordinal - View.Directory->Base;
+
+		return InvalidFunctionIndex;
+	}
+
+	// Depth counts the forwarders followed on the way to the function
+	void *LookupModuleExport(const void *Module, uint32_t Ordinal, const char *Name, uint32_t& Depth)
+	{
+		ExportDirectoryView view;
+
+		if (!GetExportDirectoryView(Module, view))
+			return nullptr;
+
+		const uint32_t functionIndex = FindExportFunctionIndex(view, Ordinal, Name);
+
+		if (functionIndex == InvalidFunctionIndex)
+			return nullptr;
+
+		return ResolveExportFunction(view, functionIndex, Depth);
+	}
+
+	void *ResolveForwarder(const char *Forwarder, uint32_t& Depth)
+	{
+		if (Depth >= MaxForwarderDepth)
+			return nullptr;
+
+		// Forwarders are formatted as "MODULE.Function" or "MODULE.#Ordinal". The loader appends ".dll" to MODULE.
+		const char *separator = nullptr;
+
+		for (auto c = Forwarder; *c; c++)
+		{
+			if (*c == '.')
+				separator = c;
+		}
+
+		if (!separator || separator == Forwarder)
+			return nullptr;
+
+		constexpr char moduleExtension[] = ".dll";
+		char moduleName[MAX_PATH];
+		const size_t moduleNameLength = separator - Forwarder;
+
+		if (moduleNameLength + sizeof(moduleExtension) > sizeof(moduleName))
+			return nullptr;
+
+		for (size_t i = 0; i < moduleNameLength; i++)
+			moduleName[i] = Forwarder[i];
+
+		for (size_t i = 0; i < sizeof(moduleExtension); i++)
+			moduleName[moduleNameLength + i] = moduleExtension[i];
+
+		// Target modules have to stay loaded, the same as the dependency the loader records when GetProcAddress
+		// follows a forwarder. Ones that are already loaded are pinned so the host freeing its own reference can't
+		// unmap them from under the stubs. Pinning again is a no-op, so the reference count isn't bumped per export.
+		// Ones that aren't loaded yet take a single reference and are found by the first branch from then on.
+		HMODULE module = nullptr;
+
+		if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_PIN, moduleName, &module))
+			module = LoadLibraryA(moduleName);
+
+		if (!module)
+			return nullptr;
+
+		const char *target = separator + 1;
+		Depth++;
+
+		if (target[0] != '#')
+			return LookupModuleExport(module, 0, target, Depth);
+
+		uint32_t ordinal = 0;
+
+		for (auto c = target + 1; *c; c++)
+		{
+			if (*c < '0' || *c > '9')
+				return nullptr;
+
+			ordinal = ordinal * 10 + (*c - '0');
+		}
+
+		return LookupModuleExport(module, ordinal, nullptr, Depth);
+	}
+
+	void *ResolveExportFunction(const ExportDirectoryView& View, uint32_t FunctionIndex, uint32_t& Depth)
+	{
+		const uint32_t functionRva = View.Functions[FunctionIndex];
+
+		// Unused slots in the ordinal range are zero
+		if (functionRva == 0)
+			return nullptr;
+
+		if (functionRva >= View.DirectoryStart && functionRva < View.DirectoryEnd)
+			return ResolveForwarder(reinterpret_cast<const char *>(View.ModuleBase + functionRva), Depth);
+
+		return reinterpret_cast<void *>(View.ModuleBase + functionRva);
+	}
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+	constexpr uint32_t UnknownChainDepth = 0xFFFFFFFF;
+
+	// Number of forwarders and import thunks skipped for each export. 0 if the resolver already returned the code.
+	constinit std::array<uint8_t, Section::ExportCount> ExportChainDepths {};
+
+	// Forwarders followed by the lookup that produced each export's pointer, so CollapseExportChain doesn't walk them
+	// a second time. UnknownChainDepth for resolvers that don't say, e.g. GetProcAddress.
+	constinit std::array<uint32_t, Section::ExportCount> ResolvedChainDepths {};
+
+	const void *GetContainingModule(const void *Address)
+	{
+		HMODULE module = nullptr;
+
+		if (!Address || !GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, static_cast<LPCWSTR>(Address), &module))
+			return nullptr;
+
+		return module;
+	}
+
+#if defined(DLL_PROXY_COLLAPSE_IMPORT_THUNKS)
+	// Only slots in the import address table directory are followed. The loader fills them once. Delay-load slots live
+	// elsewhere and point at the delay-load helper until their first call.
+	bool IsImportAddressTableSlot(const void *Module, const void *Slot)
+	{
+		const auto moduleBase = reinterpret_cast<uintptr_t>(Module);
+		auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(moduleBase);
+		auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(moduleBase + dosHeader->e_lfanew);
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE || ntHeaders->Signature != IMAGE_NT_SIGNATURE)
+			return false;
+
+		const auto& iatDirectory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IAT];
+		const auto slot = reinterpret_cast<uintptr_t>(Slot);
+
+		return slot >= moduleBase + iatDirectory.VirtualAddress &&
+			slot + sizeof(void *) <= moduleBase + iatDirectory.VirtualAddress + iatDirectory.Size;
+	}
+
+	// Returns the slot a "jmp [slot]" import thunk at Function jumps through, or nullptr if Function is anything else
+	void **GetImportThunkSlot(const void *Function)
+	{
+		auto code = static_cast<const uint8_t *>(Function);
+
+#if defined(_M_X64)
+		// REX.W prefix emitted in front of some thunks
+		if (code[0] == 0x48)
+			code++;
+#endif // _M_X64
+
+		if (code[0] != 0xFF || code[1] != 0x25)
+			return nullptr;
+
+		uint32_t operand = 0;
+
+		for (size_t i = 0; i < sizeof(operand); i++)
+			operand |= static_cast<uint32_t>(code[2 + i]) << (i * 8);
+
+#if defined(_M_IX86)
+		return reinterpret_cast<void **>(operand);
+#elif defined(_M_X64) // _M_IX86
+		return reinterpret_cast<void **>(reinterpret_cast<uintptr_t>(code) + 6 + static_cast<int32_t>(operand));
+#endif // _M_X64
+	}
+#endif // DLL_PROXY_COLLAPSE_IMPORT_THUNKS
+
+	// Called on every resolved export before it's handed to a stub. Forwarder and API set chains are followed down to
+	// the implementing module, then with DLL_PROXY_COLLAPSE_IMPORT_THUNKS import thunks that only jump through an IAT
+	// slot are skipped, so stubs reach the real code in one hop. Module is the original library the export was
+	// resolved against.
+	void *CollapseExportChain(const void *Module, size_t ExportIndex, void *FunctionPointer)
+	{
+		const auto& entry = Section::ExportTable[ExportIndex];
+		void *pointer = FunctionPointer;
+		uint32_t depth = 0;
+
+		const auto module = GetContainingModule(pointer);
+		const auto offset = reinterpret_cast<uintptr_t>(pointer) - reinterpret_cast<uintptr_t>(module);
+		ExportDirectoryView view;
+
+		if (module && GetExportDirectoryView(module, view) && offset >= view.DirectoryStart && offset < view.DirectoryEnd)
+		{
+			// Resolvers that walk export directories by hand may hand back the forwarder string itself
+			pointer = ResolveForwarder(static_cast<const char *>(pointer), depth);
+
+			if (!pointer)
+			{
+				ExportChainDepths[ExportIndex] = 0;
+				return FunctionPointer;
+			}
+		}
+		else if (module && module != Module)
+		{
+			depth = ResolvedChainDepths[ExportIndex];
+
+			// GetProcAddress follows forwarders without saying so. Walk the chain again to count its links, unless a
+			// custom resolver sent the export somewhere else entirely.
+			if (depth == UnknownChainDepth)
+			{
+				depth = 0;
+
+				if (LookupModuleExport(Module, entry.Ordinal, entry.Name, depth) != pointer)
+					depth = 0;
+			}
+		}
+
+#if defined(DLL_PROXY_COLLAPSE_IMPORT_THUNKS)
+		while (depth < MaxForwarderDepth)
+		{
+			const auto thunkModule = GetContainingModule(pointer);
+
+			if (!thunkModule)
+				break;
+
+			const auto slot = GetImportThunkSlot(pointer);
+
+			if (!slot || !IsImportAddressTableSlot(thunkModule, slot) || !*slot)
+				break;
+
+			pointer = *slot;
+			depth++;
+		}
+#endif // DLL_PROXY_COLLAPSE_IMPORT_THUNKS
+
+		ExportChainDepths[ExportIndex] = static_cast<uint8_t>(depth);
+		return pointer;
+	}
+#endif // DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+
+	// Calls RealExportResolver for a single export. With DLL_PROXY_COLLAPSE_EXPORT_CHAINS the built-in directory
+	// resolver is inlined so the forwarders it follows are counted on the way.
+	bool ResolveRealExport(void *Module, size_t ExportIndex, void **FunctionPointer)
+	{
+		const auto& entry = Section::ExportTable[ExportIndex];
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+		if constexpr (RealExportResolver == &ExportDirectoryResolverCallback)
+		{
+			uint32_t depth = 0;
+			const auto pointer = LookupModuleExport(Module, entry.Ordinal, entry.Name, depth);
+
+			if (!pointer)
+				return false;
+
+			ResolvedChainDepths[ExportIndex] = depth;
+			*FunctionPointer = pointer;
+			return true;
+		}
+		else
+		{
+			ResolvedChainDepths[ExportIndex] = UnknownChainDepth;
+			return RealExportResolver(Module, entry.Ordinal, entry.Name, FunctionPointer);
+		}
+#else
+		return RealExportResolver(Module, entry.Ordinal, entry.Name, FunctionPointer);
+#endif // DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+	}
+
+#if defined(DLL_PROXY_MEMORY_LIBRARY_LOADER)
+	//
+	// Maps an original library from a buffer instead of from disk. The result is never added to the loader's module
+	// list, so GetProcAddress and GetModuleHandle don't know about it. Its exports are looked up through the export
+	// directory instead.
+	//
+#if defined(_M_IX86)
+	constexpr WORD NativeImageMachine = IMAGE_FILE_MACHINE_I386;
+	constexpr WORD NativeRelocationType = IMAGE_REL_BASED_HIGHLOW;
+#elif defined(_M_X64) // _M_IX86
+	constexpr WORD NativeImageMachine = IMAGE_FILE_MACHINE_AMD64;
+	constexpr WORD NativeRelocationType = IMAGE_REL_BASED_DIR64;
+#endif // _M_X64
+
+	using PfnImageEntryPoint = BOOL(WINAPI *)(HINSTANCE Instance, DWORD Reason, LPVOID Reserved);
+
+	void CopyImageBytes(uint8_t *Destination, const uint8_t *Source, size_t Length)
+	{
+		for (size_t i = 0; i < Length; i++)
+			Destination[i] = Source[i];
+	}
+
+	// The buffer comes from the caller and may be malformed. Every RVA is checked against the mapping before it's
+	// followed.
+	bool IsImageRangeValid(const IMAGE_NT_HEADERS *NtHeaders, uint64_t Rva, uint64_t Length)
+	{
+		const uint64_t imageSize = NtHeaders->OptionalHeader.SizeOfImage;
+		return Rva <= imageSize && Length <= imageSize - Rva;
+	}
+
+	bool IsImageStringValid(const uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders, uint64_t Rva)
+	{
+		for (uint64_t i = Rva; i < NtHeaders->OptionalHeader.SizeOfImage; i++)
+		{
+			if (Base[i] == '\0')
+				return true;
+		}
+
+		return false;
+	}
+
+	bool IsImageDirectoryValid(const IMAGE_NT_HEADERS *NtHeaders, uint32_t Index, size_t MinimumSize)
+	{
+		const auto& directory = NtHeaders->OptionalHeader.DataDirectory[Index];
+
+		if (directory.Size == 0)
+			return true;
+
+		return IsImageRangeValid(NtHeaders, directory.VirtualAddress, directory.Size) &&
+			IsImageRangeValid(NtHeaders, directory.VirtualAddress, MinimumSize);
+	}
+
+	bool ApplyImageRelocations(uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders)
+	{
+		const auto delta = reinterpret_cast<uintptr_t>(Base) - static_cast<uintptr_t>(NtHeaders->OptionalHeader.ImageBase);
+
+		if (delta == 0)
+			return true;
+
+		const auto& directory = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+
+		if ((NtHeaders->FileHeader.Characteristics & IMAGE_FILE_RELOCS_STRIPPED) || directory.Size == 0)
+			return false;
+
+		for (uint32_t offset = 0; offset + sizeof(IMAGE_BASE_RELOCATION) <= directory.Size;)
+		{
+			const auto block = reinterpret_cast<const IMAGE_BASE_RELOCATION *>(Base + directory.VirtualAddress + offset);
+
+			if (block->SizeOfBlock < sizeof(IMAGE_BASE_RELOCATION) || block->SizeOfBlock > directory.Size - offset)
+				return false;
+
+			const auto entries = reinterpret_cast<const uint16_t *>(block + 1);
+			const uint32_t entryCount = (block->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(uint16_t);
+
+			for (uint32_t i = 0; i < entryCount; i++)
+			{
+				const uint32_t type = entries[i] >> 12;
+				const uint64_t targetRva = static_cast<uint64_t>(block->VirtualAddress) + (entries[i] & 0xFFF);
+
+				if (type == NativeRelocationType && IsImageRangeValid(NtHeaders, targetRva, sizeof(uintptr_t)))
+					*reinterpret_cast<uintptr_t *>(Base + targetRva) += delta;
+				else if (type != IMAGE_REL_BASED_ABSOLUTE)
+					return false;
+			}
+
+			offset += block->SizeOfBlock;
+		}
+
+		return true;
+	}
+
+	bool ResolveImportDescriptor(uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders, const IMAGE_IMPORT_DESCRIPTOR *Descriptor, HMODULE Module)
+	{
+		// Older linkers leave out the lookup table. The address table holds the same entries until it's filled in.
+		const uint64_t lookupRva = Descriptor->OriginalFirstThunk ? Descriptor->OriginalFirstThunk : Descriptor->FirstThunk;
+		const uint64_t addressRva = Descriptor->FirstThunk;
+
+		for (uint64_t offset = 0;; offset += sizeof(IMAGE_THUNK_DATA))
+		{
+			if (!IsImageRangeValid(NtHeaders, lookupRva + offset, sizeof(IMAGE_THUNK_DATA)) ||
+				!IsImageRangeValid(NtHeaders, addressRva + offset, sizeof(IMAGE_THUNK_DATA)))
+				return false;
+
+			const auto lookup = reinterpret_cast<const IMAGE_THUNK_DATA *>(Base + lookupRva + offset);
+			const auto address = reinterpret_cast<IMAGE_THUNK_DATA *>(Base + addressRva + offset);
+
+			if (lookup->u1.AddressOfData == 0)
+				return true;
+
+			FARPROC function = nullptr;
+
+			if (IMAGE_SNAP_BY_ORDINAL(lookup->u1.Ordinal))
+			{
+				function = GetProcAddress(Module, MAKEINTRESOURCEA(IMAGE_ORDINAL(lookup->u1.Ordinal)));
+			}
+			else
+			{
+				const uint64_t nameRva = lookup->u1.AddressOfData + offsetof(IMAGE_IMPORT_BY_NAME, Name);
+
+				if (IsImageStringValid(Base, NtHeaders, nameRva))
+					function = GetProcAddress(Module, reinterpret_cast<const char *>(Base + nameRva));
+			}
+
+			if (!function)
+				return false;
+
+			address->u1.Function = reinterpret_cast<uintptr_t>(function);
+		}
+	}
+
+	// Last loaded first, the same order the loader unloads them in
+	void FreeImageImports(HMODULE *Modules, uint32_t ModuleCount)
+	{
+		if (!Modules)
+			return;
+
+		for (uint32_t i = ModuleCount; i > 0; i--)
+			FreeLibrary(Modules[i - 1]);
+
+		HeapFree(GetProcessHeap(), 0, Modules);
+	}
+
+	// Modules receives every library loaded for the image so they can be freed again if it fails to load later on.
+	// Libraries loaded before a failure here are freed right away.
+	bool ResolveImageImports(uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders, HMODULE *&Modules, uint32_t& ModuleCount)
+	{
+		const auto& directory = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+
+		Modules = nullptr;
+		ModuleCount = 0;
+
+		if (directory.Size == 0)
+			return true;
+
+		// The directory normally covers the empty descriptor at the end of the list as well. Leave room for one more
+		// in case it doesn't.
+		const uint32_t capacity = directory.Size / sizeof(IMAGE_IMPORT_DESCRIPTOR) + 1;
+		Modules = static_cast<HMODULE *>(HeapAlloc(GetProcessHeap(), 0, capacity * sizeof(HMODULE)));
+
+		if (!Modules)
+			return false;
+
+		bool status = true;
+
+		// Delay-load imports are left to the image's own helper, which finds them the first time they're called
+		for (uint64_t descriptorRva = directory.VirtualAddress; status; descriptorRva += sizeof(IMAGE_IMPORT_DESCRIPTOR))
+		{
+			status = ModuleCount < capacity && IsImageRangeValid(NtHeaders, descriptorRva, sizeof(IMAGE_IMPORT_DESCRIPTOR));
+
+			if (!status)
+				break;
+
+			const auto descriptor = reinterpret_cast<const IMAGE_IMPORT_DESCRIPTOR *>(Base + descriptorRva);
+
+			if (descriptor->Name == 0)
+				break;
+
+			const HMODULE module = IsImageStringValid(Base, NtHeaders, descriptor->Name) ? LoadLibraryA(reinterpret_cast<const char *>(Base + descriptor->Name)) : nullptr;
+
+			if (module)
+				Modules[ModuleCount++] = module;
+
+			status = module && ResolveImportDescriptor(Base, NtHeaders, descriptor, module);
+		}
+
+		if (!status)
+		{
+			FreeImageImports(Modules, ModuleCount);
+			Modules = nullptr;
+			ModuleCount = 0;
+		}
+
+		return status;
+	}
+
+	// Static TLS data needs an index into every thread's TLS array, and only the loader hands those out. Code in an
+	// image mapped here would use index 0 and overwrite the host executable's thread locals.
+	bool HasStaticTlsData(const uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders)
+	{
+		const auto& directory = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_TLS];
+
+		if (directory.Size == 0)
+			return false;
+
+		const auto tls = reinterpret_cast<const IMAGE_TLS_DIRECTORY *>(Base + directory.VirtualAddress);
+		return tls->EndAddressOfRawData - tls->StartAddressOfRawData + tls->SizeOfZeroFill != 0;
+	}
+
+	// AddressOfCallBacks is a virtual address. Only meaningful once relocations were applied.
+	bool AreImageTlsCallbacksValid(const uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders)
+	{
+		const auto& directory = NtHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_TLS];
+
+		if (directory.Size == 0)
+			return true;
+
+		const auto tls = reinterpret_cast<const IMAGE_TLS_DIRECTORY *>(Base + directory.VirtualAddress);
+
+		if (tls->AddressOfCallBacks == 0)
+			return true;
+
+		// Callbacks below the base wrap around to an RVA past the end of the image
+		for (uint64_t rva = static_cast<uintptr_t>(tls->AddressOfCallBacks - reinterpret_cast<uintptr_t>(Base));; rva += sizeof(PIMAGE_TLS_CALLBACK))
+		{
+			if (!IsImageRangeValid(NtHeaders, rva, sizeof(PIMAGE_TLS_CALLBACK)))
+				return false;
+
+			if (!*reinterpret_cast<const PIMAGE_TLS_CALLBACK *>(Base + rva))
+				return true;
+		}
+	}
+
+	DWORD GetSectionProtection(DWORD Characteristics)
+	{
+		const bool execute = (Characteristics & IMAGE_SCN_MEM_EXECUTE) != 0;
+		const bool read = (Characteristics & IMAGE_SCN_MEM_READ) != 0;
+		const bool write = (Characteristics & IMAGE_SCN_MEM_WRITE) != 0;
+
+		if (execute)
+			return write ? PAGE_EXECUTE_READWRITE : (read ? PAGE_EXECUTE_READ : PAGE_EXECUTE);
+
+		if (write)
+			return PAGE_READWRITE;
+
+		return read ? PAGE_READONLY : PAGE_NOACCESS;
+	}
+
+	bool ProtectImageSections(uint8_t *Base, const IMAGE_NT_HEADERS *NtHeaders)
+	{
+		const auto& optionalHeader = NtHeaders->OptionalHeader;
+		DWORD oldProtection = 0;
+
+		// Sections packed tighter than a page share pages with each other. Give up on per-section protection.
+		if (optionalHeader.SectionAlignment < Section::DefaultPageAlign)
+			return VirtualProtect(Base, optionalHeader.SizeOfImage, PAGE_EXECUTE_READWRITE, &oldProtection) != FALSE;
+
+		if (!VirtualProtect(Base, optionalHeader.SizeOfHeaders, PAGE_READONLY, &oldProtection))
+			return false;
+
+		const auto sections = IMAGE_FIRST_SECTION(NtHeaders);
+
+		for (uint32_t i = 0; i < NtHeaders->FileHeader.NumberOfSections; i++)
+		{
+			const auto& section = sections[i];
+			const uint32_t size = section.Misc.VirtualSize ? section.Misc.VirtualSize : section.SizeOfRawData;
+
+			if (size != 0 && !VirtualProtect(Base + section.VirtualAddress, size, GetSectionProtection(section.Characteristics), &oldProtection))
+				return false;
+		}
+
+		return true;
+	}
+
+	void *LoadLibraryFromMemoryImpl(const void *Image, size_t Size)
+	{
+		const auto image = static_cast<const uint8_t *>(Image);
+
+		if (!image || Size < sizeof(IMAGE_DOS_HEADER))
+			return nullptr;
+
+		const auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(image);
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE || dosHeader->e_lfanew < 0 ||
+			static_cast<size_t>(dosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS) > Size)
+			return nullptr;
+
+		const auto fileHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(image + dosHeader->e_lfanew);
+		const auto& optionalHeader = fileHeaders->OptionalHeader;
+
+		if (fileHeaders->Signature != IMAGE_NT_SIGNATURE ||
+			fileHeaders->FileHeader.Machine != NativeImageMachine ||
+			(fileHeaders->FileHeader.Characteristics & IMAGE_FILE_DLL) == 0 ||
+			optionalHeader.Magic != IMAGE_NT_OPTIONAL_HDR_MAGIC ||
+			optionalHeader.SizeOfHeaders > Size ||
+			optionalHeader.SizeOfHeaders > optionalHeader.SizeOfImage)
+			return nullptr;
+
+		// Try the preferred base first so relocations can be skipped
+		auto base = static_cast<uint8_t *>(VirtualAlloc(reinterpret_cast<void *>(optionalHeader.ImageBase), optionalHeader.SizeOfImage, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+
+		if (!base)
+			base = static_cast<uint8_t *>(VirtualAlloc(nullptr, optionalHeader.SizeOfImage, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+
+		if (!base)
+			return nullptr;
+
+		CopyImageBytes(base, image, optionalHeader.SizeOfHeaders);
+
+		const auto ntHeaders = reinterpret_cast<IMAGE_NT_HEADERS *>(base + dosHeader->e_lfanew);
+		const auto sections = IMAGE_FIRST_SECTION(ntHeaders);
+		bool status = reinterpret_cast<const uint8_t *>(sections + ntHeaders->FileHeader.NumberOfSections) <= base + optionalHeader.SizeOfHeaders;
+
+		for (uint32_t i = 0; status && i < ntHeaders->FileHeader.NumberOfSections; i++)
+		{
+			const auto& section = sections[i];
+			uint32_t length = section.SizeOfRawData;
+
+			// Raw data is padded to the file alignment and may run past the section's actual size
+			if (section.Misc.VirtualSize != 0 && section.Misc.VirtualSize < length)
+				length = section.Misc.VirtualSize;
+
+			status = section.PointerToRawData <= Size && length <= Size - section.PointerToRawData &&
+				section.VirtualAddress <= optionalHeader.SizeOfImage && length <= optionalHeader.SizeOfImage - section.VirtualAddress;
+
+			if (status && length != 0)
+				CopyImageBytes(base + section.VirtualAddress, image + section.PointerToRawData, length);
+		}
+
+		// Only the directories followed below
+		status = status && ntHeaders->OptionalHeader.AddressOfEntryPoint < optionalHeader.SizeOfImage &&
+			IsImageDirectoryValid(ntHeaders, IMAGE_DIRECTORY_ENTRY_BASERELOC, 0) &&
+			IsImageDirectoryValid(ntHeaders, IMAGE_DIRECTORY_ENTRY_IMPORT, 0) &&
+			IsImageDirectoryValid(ntHeaders, IMAGE_DIRECTORY_ENTRY_TLS, sizeof(IMAGE_TLS_DIRECTORY)) &&
+			IsImageDirectoryValid(ntHeaders, IMAGE_DIRECTORY_ENTRY_EXCEPTION, 0);
+
+		if (status && HasStaticTlsData(base, ntHeaders))
+		{
+			VirtualFree(base, 0, MEM_RELEASE);
+			SetLastError(ERROR_NOT_SUPPORTED);
+			return nullptr;
+		}
+
+		HMODULE *importedModules = nullptr;
+		uint32_t importedModuleCount = 0;
+
+		status = status && ApplyImageRelocations(base, ntHeaders) && AreImageTlsCallbacksValid(base, ntHeaders) &&
+			ResolveImageImports(base, ntHeaders, importedModules, importedModuleCount);
+
+		// The loader records the actual base here as well. Anything that reads the headers later sees this copy.
+		if (status)
+			ntHeaders->OptionalHeader.ImageBase = reinterpret_cast<uintptr_t>(base);
+
+		status = status && ProtectImageSections(base, ntHeaders);
+
+		if (!status)
+		{
+			FreeImageImports(importedModules, importedModuleCount);
+			VirtualFree(base, 0, MEM_RELEASE);
+			return nullptr;
+		}
+
+		FlushInstructionCache(GetCurrentProcess(), base, optionalHeader.SizeOfImage);
+
+#if defined(_M_X64)
+		// Without its unwind data nothing can throw through or walk the stack of this image
+		const auto& exceptionDirectory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXCEPTION];
+		const auto functionTable = reinterpret_cast<PRUNTIME_FUNCTION>(base + exceptionDirectory.VirtualAddress);
+
+		if (exceptionDirectory.Size != 0)
+			RtlAddFunctionTable(functionTable, exceptionDirectory.Size / sizeof(RUNTIME_FUNCTION), reinterpret_cast<DWORD64>(base));
+#elif defined(_M_IX86) // _M_X64
+		// There's no x86 counterpart. SafeSEH handler tables are only looked up for images in the loader's module list,
+		// so the dispatcher rejects every handler registered by code in this image.
+#endif // _M_IX86
+
+		// Images with static TLS data were turned away above. Only the callbacks are left to run.
+		const auto& tlsDirectory = ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_TLS];
+
+		if (tlsDirectory.Size != 0)
+		{
+			const auto tls = reinterpret_cast<const IMAGE_TLS_DIRECTORY *>(base + tlsDirectory.VirtualAddress);
+
+			for (auto callback = reinterpret_cast<const PIMAGE_TLS_CALLBACK *>(tls->AddressOfCallBacks); callback && *callback; callback++)
+				(*callback)(base, DLL_PROCESS_ATTACH, nullptr);
+		}
+
+		if (ntHeaders->OptionalHeader.AddressOfEntryPoint != 0)
+		{
+			const auto entryPoint = reinterpret_cast<PfnImageEntryPoint>(base + ntHeaders->OptionalHeader.AddressOfEntryPoint);
+
+			if (!entryPoint(reinterpret_cast<HINSTANCE>(base), DLL_PROCESS_ATTACH, nullptr))
+			{
+#if defined(_M_X64)
+				if (exceptionDirectory.Size != 0)
+					RtlDeleteFunctionTable(functionTable);
+#endif // _M_X64
+
+				FreeImageImports(importedModules, importedModuleCount);
+				VirtualFree(base, 0, MEM_RELEASE);
+				return nullptr;
+			}
+		}
+
+		// The image keeps its references to the libraries it imports
+		if (importedModules)
+			HeapFree(GetProcessHeap(), 0, importedModules);
+		return base;
+	}
+#endif // DLL_PROXY_MEMORY_LIBRARY_LOADER
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER)
+	// Pass the comparator as a templated type to avoid the need for std::function's allocations
+	template<typename T>
+	requires(std::is_invocable_r_v<bool, T, uint32_t /* Left */, uint32_t /* Right */>)
+	void HeapSort(uint32_t *Values, size_t Count, T&& Less)
+	{
+		const auto siftDown = [&](size_t Root, size_t End)
+		{
+			while (2 * Root + 1 < End)
+			{
+				size_t child = 2 * Root + 1;
+
+				if (child + 1 < End && Less(Values[child], Values[child + 1]))
+					child++;
+
+				if (!Less(Values[Root], Values[child]))
+					return;
+
+				std::swap(Values[Root], Values[child]);
+				Root = child;
+			}
+		};
+
+		for (size_t i = Count / 2; i-- > 0;)
+			siftDown(i, Count);
+
+		for (size_t end = Count; end-- > 1;)
+		{
+			std::swap(Values[0], Values[end]);
+			siftDown(0, end);
+		}
+	}
+
+	void ResolveExportsFromDirectory(const void *Module, const Section::LibraryEntry& Library, std::array<void *, Section::ExportCount>& Pointers)
+	{
+		ExportDirectoryView view;
+
+		if (!GetExportDirectoryView(Module, view))
+			return;
+
+		// Sort our own names once so they can be matched against the export name table, which is already sorted,
+		// in a single merge pass instead of one lookup per export. Only this library's exports take part.
+		constinit static std::array<uint32_t, Section::ExportCount> sortedIndices {};
+		const uint32_t exportEnd = Library.FirstExport + Library.ExportCount;
+
+		for (uint32_t i = 0; i < Library.ExportCount; i++)
+			sortedIndices[i] = Library.FirstExport + i;
+
+		HeapSort(sortedIndices.data(), Library.ExportCount, [](uint32_t Left, uint32_t Right)
+		{
+			return CompareExportNames(Section::ExportTable[Left].Name, Section::ExportTable[Right].Name) < 0;
+		});
+
+		for (uint32_t i = 0, j = 0; i < Library.ExportCount && j < view.Directory->NumberOfNames;)
+		{
+			const uint32_t index = sortedIndices[i];
+			const int result = CompareExportNames(Section::ExportTable[index].Name, reinterpret_cast<const char *>(view.ModuleBase + view.Names[j]));
+
+			if (result < 0)
+			{
+				i++;
+			}
+			else if (result > 0)
+			{
+				j++;
+			}
+			else
+			{
+				// Don't advance j. Listings may declare the same name more than once.
+				uint32_t depth = 0;
+				Pointers[index] = ResolveExportFunction(view, view.NameOrdinals[j], depth);
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+				ResolvedChainDepths[index] = depth;
+#endif
+				i++;
+			}
+		}
+
+		// Fall back to ordinals for anything the names didn't match, e.g. "Ordinal_1101" placeholders
+		for (uint32_t i = Library.FirstExport; i < exportEnd; i++)
+		{
+			if (Pointers[i])
+				continue;
+
+			const uint32_t functionIndex = FindExportFunctionIndex(view, Section::ExportTable[i].Ordinal, nullptr);
+			uint32_t depth = 0;
+
+			if (functionIndex != InvalidFunctionIndex)
+				Pointers[i] = ResolveExportFunction(view, functionIndex, depth);
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+			ResolvedChainDepths[i] = depth;
+#endif
+		}
+	}
+#endif // DLL_PROXY_EXPORT_DIRECTORY_RESOLVER
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+	//
+	// On-disk cache of export RVAs in the original modules. Each module is identified by the same header fields the
+	// loader uses to validate bound imports. This DLL's own identity stands in for the listing since changing the
+	// listing means rebuilding it. An RVA of 0 marks an export that has to go through the resolver every time, e.g.
+	// one forwarded to another module or redirected by a custom resolver.
+	//
+	struct ResolutionCacheKey
+	{
+		uint32_t TimeDateStamp;
+		uint32_t SizeOfImage;
+		uint32_t CheckSum;
+
+		bool operator==(const ResolutionCacheKey&) const = default;
+	};
+
+	struct ResolutionCacheFile
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t LibraryCount;
+		uint32_t ExportCount;
+		ResolutionCacheKey Proxy;
+		std::array<ResolutionCacheKey, Section::LibraryCount> Libraries;
+		std::array<uint32_t, Section::ExportCount> Rvas;
+	};
+
+	struct ResolutionCacheView
+	{
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE Mapping = nullptr;
+		void *Data = nullptr;
+	};
+
+	constexpr wchar_t ResolutionCachePath[] = DLL_PROXY_RESOLUTION_CACHE_PATH;
+	constexpr uint32_t ResolutionCacheMagic = 0x43525044; // "DPRC"
+	constexpr uint32_t ResolutionCacheVersion = 1;
+
+	bool GetModuleCacheKey(const void *Module, ResolutionCacheKey& Key)
+	{
+		if (!Module)
+			return false;
+
+		const auto moduleBase = reinterpret_cast<uintptr_t>(Module);
+		const auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(moduleBase);
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+			return false;
+
+		const auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(moduleBase + dosHeader->e_lfanew);
+
+		if (ntHeaders->Signature != IMAGE_NT_SIGNATURE)
+			return false;
+
+		Key.TimeDateStamp = ntHeaders->FileHeader.TimeDateStamp;
+		Key.SizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+		Key.CheckSum = ntHeaders->OptionalHeader.CheckSum;
+		return true;
+	}
+
+	void UnmapResolutionCache(ResolutionCacheView& View)
+	{
+		if (View.Data)
+			UnmapViewOfFile(View.Data);
+
+		if (View.Mapping)
+			CloseHandle(View.Mapping);
+
+		if (View.File != INVALID_HANDLE_VALUE)
+			CloseHandle(View.File);
+
+		View = {};
+	}
+
+	// Returns nullptr if there's no cache or it was written by a different build of this DLL. Libraries are checked
+	// individually by ReadCachedExports.
+	const ResolutionCacheFile *MapResolutionCache(ResolutionCacheView& View)
+	{
+		View.File = CreateFileW(ResolutionCachePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (View.File == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		LARGE_INTEGER fileSize {};
+
+		if (!GetFileSizeEx(View.File, &fileSize) || fileSize.QuadPart != sizeof(ResolutionCacheFile))
+			return nullptr;
+
+		View.Mapping = CreateFileMappingW(View.File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (!View.Mapping)
+			return nullptr;
+
+		View.Data = MapViewOfFile(View.Mapping, FILE_MAP_READ, 0, 0, 0);
+
+		const auto cache = static_cast<const ResolutionCacheFile *>(View.Data);
+		ResolutionCacheKey proxyKey {};
+
+		if (!cache || !GetModuleCacheKey(GetLocalModuleHandle(), proxyKey))
+			return nullptr;
+
+		if (cache->Magic != ResolutionCacheMagic ||
+			cache->Version != ResolutionCacheVersion ||
+			cache->LibraryCount != Section::LibraryCount ||
+			cache->ExportCount != Section::ExportCount ||
+			!(cache->Proxy == proxyKey))
+			return nullptr;
+
+		return cache;
+	}
+
+	// Fills Pointers for every export of one library that has a cached RVA. Fails without touching Pointers if the
+	// loaded module isn't the one the cache was written for.
+	bool ReadCachedExports(const ResolutionCacheFile& Cache, size_t Library, const void *Module, std::array<void *, Section::ExportCount>& Pointers)
+	{
+		ResolutionCacheKey key {};
+
+		if (!GetModuleCacheKey(Module, key) || !(key == Cache.Libraries[Library]))
+			return false;
+
+		const auto& library = Section::LibraryTable[Library];
+		const auto moduleBase = reinterpret_cast<uintptr_t>(Module);
+
+		for (uint32_t i = library.FirstExport; i < library.FirstExport + library.ExportCount; i++)
+		{
+			if (Cache.Rvas[i] != 0)
+				Pointers[i] = reinterpret_cast<void *>(moduleBase + Cache.Rvas[i]);
+		}
+
+		return true;
+	}
+
+	// Best effort. Failing to write the cache only means the next process resolves everything again.
+	void WriteResolutionCache(const std::array<void *, Section::LibraryCount>& Modules, const std::array<void *, Section::ExportCount>& Pointers)
+	{
+		constinit static ResolutionCacheFile cache {};
+
+		cache.Magic = ResolutionCacheMagic;
+		cache.Version = ResolutionCacheVersion;
+		cache.LibraryCount = Section::LibraryCount;
+		cache.ExportCount = Section::ExportCount;
+
+		if (!GetModuleCacheKey(GetLocalModuleHandle(), cache.Proxy))
+			return;
+
+		for (size_t i = 0; i < Section::LibraryCount; i++)
+		{
+			if (!GetModuleCacheKey(Modules[i], cache.Libraries[i]))
+				return;
+
+			const auto& library = Section::LibraryTable[i];
+			const auto moduleBase = reinterpret_cast<uintptr_t>(Modules[i]);
+			const auto moduleEnd = moduleBase + cache.Libraries[i].SizeOfImage;
+
+			for (uint32_t j = library.FirstExport; j < library.FirstExport + library.ExportCount; j++)
+			{
+				const auto pointer = reinterpret_cast<uintptr_t>(Pointers[j]);
+				cache.Rvas[j] = (pointer > moduleBase && pointer < moduleEnd) ? static_cast<uint32_t>(pointer - moduleBase) : 0;
+			}
+		}
+
+		// Write to a temporary file next to the cache and swap it in so readers never see a partial file. The process
+		// id keeps concurrent writers apart.
+		wchar_t tempPath[ARRAYSIZE(ResolutionCachePath) + 16];
+		size_t length = 0;
+
+		for (; ResolutionCachePath[length]; length++)
+			tempPath[length] = ResolutionCachePath[length];
+
+		tempPath[length++] = L'.';
+
+		for (int shift = 28; shift >= 0; shift -= 4)
+			tempPath[length++] = L"0123456789abcdef"[(GetCurrentProcessId() >> shift) & 0xF];
+
+		for (const wchar_t c : L".tmp")
+			tempPath[length++] = c;
+
+		const HANDLE file = CreateFileW(tempPath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		DWORD bytesWritten = 0;
+		const bool status = WriteFile(file, &cache, sizeof(cache), &bytesWritten, nullptr) && bytesWritten == sizeof(cache);
+
+		CloseHandle(file);
+
+		if (!status || !MoveFileExW(tempPath, ResolutionCachePath, MOVEFILE_REPLACE_EXISTING))
+			DeleteFileW(tempPath);
+	}
+#endif // DLL_PROXY_RESOLUTION_CACHE_PATH
+
+#if defined(DLL_PROXY_ENABLE_CALL_STATS)
+	uint64_t ReadCallCounter(const Section::StubPlaceholderCode *Stub)
+	{
+#if defined(_M_IX86)
+		// Separate loads of the two halves can tear, so read both in one locked 8-byte access. Comparing against and
+		// writing zero leaves the counter unchanged either way. The carry into CountHigh is still a second instruction,
+		// so a count that just wrapped its low half can read 2^32 short until the carry lands.
+		const auto counter = reinterpret_cast<volatile LONG64 *>(Stub->CountLow);
+
+		return static_cast<uint64_t>(InterlockedCompareExchange64(counter, 0, 0));
+#else
+		return Stub->Counter->Count;
+#endif
+	}
+
+	// Writes a "<count> <name>" line for every export that was called. tools/listing_generator reads this back with
+	// --profile to put the hottest stubs first.
+	bool WriteCallStatisticsImpl(HANDLE File)
+	{
+		char buffer[4096];
+		DWORD length = 0;
+
+		const auto flush = [&]()
+		{
+			DWORD written = 0;
+			const bool status = length == 0 || (WriteFile(File, buffer, length, &written, nullptr) && written == length);
+
+			length = 0;
+			return status;
+		};
+
+		const auto append = [&](const char *Data, size_t DataLength)
+		{
+			for (size_t i = 0; i < DataLength; i++)
+			{
+				if (length == sizeof(buffer) && !flush())
+					return false;
+
+				buffer[length++] = Data[i];
+			}
+
+			return true;
+		};
+
+		// Digits come from subtracting powers of ten. 64-bit division is a CRT helper on x86.
+		constexpr auto powersOfTen = []()
+		{
+			std::array<uint64_t, 20> powers {};
+			uint64_t power = 1;
+
+			for (size_t i = powers.size(); i-- > 0; power *= 10)
+				powers[i] = power;
+
+			return powers;
+		}();
+
+		for (const auto& entry : Section::ExportTable)
+		{
+			uint64_t count = ReadCallCounter(entry.Stub);
+
+			if (count == 0)
+				continue;
+
+			char digits[21];
+			size_t digitCount = 0;
+
+			for (const auto power : powersOfTen)
+			{
+				char digit = '0';
+
+				while (count >= power)
+				{
+					count -= power;
+					digit++;
+				}
+
+				if (digit != '0' || digitCount != 0)
+					digits[digitCount++] = digit;
+			}
+
+			digits[digitCount++] = ' ';
+
+			size_t nameLength = 0;
+
+			while (entry.Name[nameLength])
+				nameLength++;
+
+			if (!append(digits, digitCount) || !append(entry.Name, nameLength) || !append("\n", 1))
+				return false;
+		}
+
+		return flush();
+	}
+#endif // DLL_PROXY_ENABLE_CALL_STATS
+
+	// Returns what a stub should jump to once its export resolves. Hooked exports hand the real function to
+	// DllProxy::Original first.
+	void *ApplyExportHook(size_t ExportIndex, void *FunctionPointer)
+	{
+		size_t low = 0;
+		size_t high = Section::HookCount;
+
+		while (low < high)
+		{
+			const size_t middle = low + (high - low) / 2;
+
+			if (Section::HookTable[middle].ExportIndex < ExportIndex)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		if (low < Section::HookCount && Section::HookTable[low].ExportIndex == ExportIndex)
+			return Section::HookTable[low].Bind(FunctionPointer);
+
+		return FunctionPointer;
+	}
+
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+	void **GetStubDestinationSlot(const Section::StubPlaceholderCode *Stub)
+	{
+#if defined(_M_IX86)
+		return Stub->JmpDwordEipAddress;
+#elif defined(__GNUC__) // _M_IX86
+		// rip points past the displacement
+		const auto nextInstruction = reinterpret_cast<uintptr_t>(&Stub->JmpQwordRipOffset + 1);
+		return reinterpret_cast<void **>(nextInstruction + Stub->JmpQwordRipOffset);
+#else // __GNUC__
+		return Stub->MovRaxDestination;
+#endif
+	}
+#endif // DLL_PROXY_READ_ONLY_STUBS
+
+#if defined(_M_X64) && defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS)
+	// Whether Code, the stub's first bytes, is still what it was built with in place of the indirect jump
+	bool IsUnresolvedStubJump(const Section::StubPlaceholderCode *Stub, const uint8_t *Code)
+	{
+#if defined(__GNUC__)
+		constexpr size_t JmpRel32Length = 5;
+		const auto thunkDisplacement = reinterpret_cast<intptr_t>(&Section::XPROXY_UnresolvedExportThunk) - (reinterpret_cast<intptr_t>(Stub) + JmpRel32Length);
+		uint32_t displacement = 0;
+
+		for (size_t i = 0; i < sizeof(int32_t); i++)
+			displacement |= static_cast<uint32_t>(Code[1 + i]) << (i * 8);
+
+		return Code[0] == 0xE9 && static_cast<int32_t>(displacement) == thunkDisplacement;
+#else // __GNUC__
+		for (size_t i = 0; i < sizeof(Section::UnresolvedExportFastFail); i++)
+		{
+			if (Code[i] != Section::UnresolvedExportFastFail[i])
+				return false;
+		}
+
+		return true;
+#endif // __GNUC__
+	}
+#endif // _M_X64 && DLL_PROXY_POSITION_INDEPENDENT_STUBS
+
+	void PatchStubDestination(Section::StubPlaceholderCode *Stub, void *Destination)
+	{
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+		// The stub only holds the address of its destination. Code is left untouched.
+		InterlockedExchangePointer(GetStubDestinationSlot(Stub), Destination);
+#elif defined(_M_IX86) && defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) // DLL_PROXY_READ_ONLY_STUBS
+		// The displacement isn't 4 byte aligned. Swap the first 8 bytes at once, same as PatchStubDirectJump.
+		constexpr size_t JmpRel32Length = 5;
+		const auto displacement = reinterpret_cast<intptr_t>(Destination) - (reinterpret_cast<intptr_t>(Stub) + JmpRel32Length);
+		const auto code = reinterpret_cast<volatile LONGLONG *>(Stub);
+		LONGLONG oldCode;
+		LONGLONG newCode;
+
+		do
+		{
+			oldCode = *code;
+			newCode = oldCode;
+
+			const auto bytes = reinterpret_cast<uint8_t *>(&newCode);
+
+			for (size_t i = 0; i < sizeof(int32_t); i++)
+				bytes[1 + i] = static_cast<uint8_t>(static_cast<uint32_t>(displacement) >> (i * 8));
+		} while (InterlockedCompareExchange64(code, newCode, oldCode) != oldCode);
+#elif defined(_M_IX86) // _M_IX86 && DLL_PROXY_POSITION_INDEPENDENT_STUBS
+		auto ptr = &Stub->JmpDwordDestination;
+
+		static_assert(sizeof(*ptr) == sizeof(LONG), "Expected pointer to be 32 bits");
+		InterlockedExchange(reinterpret_cast<LONG *>(ptr), reinterpret_cast<LONG>(Destination));
+#elif defined(_M_X64) // _M_IX86
+		auto __unaligned ptr = &Stub->JmpQwordDestination;
+
+		static_assert(sizeof(*ptr) == sizeof(LONGLONG), "Expected pointer to be 64 bits");
+		InterlockedExchange64(reinterpret_cast<LONGLONG *>(ptr), reinterpret_cast<LONGLONG>(Destination));
+
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS)
+		// Stubs that still start out unresolved go back to jmp qword ptr [rip] now that the destination is in place.
+		// Direct jumps are left to PatchStubDirectJump. The swap covers the first two destination bytes as well, so
+		// it's retried if they change in between.
+		const auto code = reinterpret_cast<volatile LONGLONG *>(Stub);
+		LONGLONG oldCode;
+		LONGLONG newCode;
+
+		do
+		{
+			oldCode = *code;
+			newCode = oldCode;
+
+			const auto bytes = reinterpret_cast<uint8_t *>(&newCode);
+
+			if (!IsUnresolvedStubJump(Stub, bytes))
+				return;
+
+			bytes[0] = 0xFF;
+			bytes[1] = 0x25;
+
+			for (size_t i = 0; i < sizeof(int32_t); i++)
+				bytes[2 + i] = 0;
+		} while (InterlockedCompareExchange64(code, newCode, oldCode) != oldCode);
+#endif // DLL_PROXY_POSITION_INDEPENDENT_STUBS
+#endif // _M_X64
+	}
+
+	void *ReadStubDestination(const Section::StubPlaceholderCode *Stub)
+	{
+		// Direct jump patching leaves the indirect destination in place behind the rel32 jump
+#if defined(DLL_PROXY_READ_ONLY_STUBS)
+		return *GetStubDestinationSlot(Stub);
+#elif defined(_M_IX86) && defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) // DLL_PROXY_READ_ONLY_STUBS
+		// A displacement of 0 is an MSVC stub that was never written
+		const int32_t displacement = Stub->JmpRel32Displacement;
+
+		if (displacement == 0)
+			return nullptr;
+
+		return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(Stub) + sizeof(Stub->JmpRel32Opcode) + sizeof(displacement) + displacement);
+#elif defined(_M_IX86) // _M_IX86 && DLL_PROXY_POSITION_INDEPENDENT_STUBS
+		return Stub->JmpDwordDestination;
+#elif defined(_M_X64) // _M_IX86
+		return Stub->JmpQwordDestination;
+#endif // _M_X64
+	}
+
+#if defined(DLL_PROXY_DIRECT_JUMP_PATCHING)
+	// Rewrites the stub's first instruction as jmp rel32 when Destination is reachable from it. The indirect jump's
+	// destination stays valid behind it, so stubs that can't be converted keep working as they are. A stub that was
+	// converted for an earlier destination goes back to the indirect jump if the new one is out of range.
+	void PatchStubDirectJump(Section::StubPlaceholderCode *Stub, void *Destination)
+	{
+		constexpr size_t JmpRel32Length = 5;
+		const auto displacement = reinterpret_cast<intptr_t>(Destination) - (reinterpret_cast<intptr_t>(Stub) + JmpRel32Length);
+
+		// Always true on x86 where rel32 wraps around the whole address space
+		const bool reachable = static_cast<int32_t>(displacement) == displacement;
+
+		// Stubs are 16 byte aligned. Swap the first 8 bytes at once so a concurrent caller sees either instruction
+		// in full.
+		const auto code = reinterpret_cast<volatile LONGLONG *>(Stub);
+		LONGLONG oldCode;
+		LONGLONG newCode;
+
+		do
+		{
+			oldCode = *code;
+			newCode = oldCode;
+
+			const auto bytes = reinterpret_cast<uint8_t *>(&newCode);
+
+			if (reachable)
+			{
+				bytes[0] = 0xE9;
+
+				for (size_t i = 0; i < sizeof(int32_t); i++)
+					bytes[1 + i] = static_cast<uint8_t>(static_cast<uint32_t>(displacement) >> (i * 8));
+			}
+			else
+			{
+				// jmp qword ptr [rip]. Only reachable on x64.
+				if (bytes[0] != 0xE9)
+					return;
+
+				bytes[0] = 0xFF;
+				bytes[1] = 0x25;
+
+				for (size_t i = 0; i < sizeof(int32_t); i++)
+					bytes[2 + i] = 0;
+			}
+		} while (InterlockedCompareExchange64(code, newCode, oldCode) != oldCode);
+	}
+#endif // DLL_PROXY_DIRECT_JUMP_PATCHING
+
+	// Modules that stubs currently resolve against. DllProxy::Rebind swaps entries.
+	constinit std::array<void *, Section::LibraryCount> OriginalModules {};
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+	// An import slot that was pointed past its stub. Value is what was written so slots that someone else rewrote
+	// since, or that belong to a module loaded at the same address later, are left alone.
+	struct BypassedImport
+	{
+		void **Slot;
+		const Section::StubPlaceholderCode *Stub;
+		void *Module;
+		void *Value;
+	};
+
+	constinit SRWLOCK BypassLock = SRWLOCK_INIT;
+	constinit BypassedImport *BypassedImports = nullptr;
+	constinit size_t BypassedImportCount = 0;
+	constinit size_t BypassedImportCapacity = 0;
+
+	// Hooked exports keep going through their stubs
+	bool IsHookedStub(const Section::StubPlaceholderCode *Stub)
+	{
+		for (const auto& hook : Section::HookTable)
+		{
+			if (Section::ExportTable[hook.ExportIndex].Stub == Stub)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Only replaces Expected. Returns false when another thread or hooking library rewrote the slot first.
+	bool WriteImportSlot(void **Slot, void *Expected, void *Value)
+	{
+		// The loader usually leaves bound import tables read-only. A few linkers put them next to code.
+		MEMORY_BASIC_INFORMATION memoryInfo {};
+
+		if (!VirtualQuery(Slot, &memoryInfo, sizeof(memoryInfo)))
+			UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
+		constexpr DWORD writableMask = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+		constexpr DWORD executableMask = PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+		if (memoryInfo.Protect & writableMask)
+			return InterlockedCompareExchangePointer(Slot, Value, Expected) == Expected;
+
+		const DWORD newProtection = (memoryInfo.Protect & executableMask) ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+		DWORD oldProtection = 0;
+
+		if (!VirtualProtect(Slot, sizeof(*Slot), newProtection, &oldProtection))
+			UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
+		const bool written = InterlockedCompareExchangePointer(Slot, Value, Expected) == Expected;
+
+		if (!VirtualProtect(Slot, sizeof(*Slot), oldProtection, &oldProtection))
+			UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
+		return written;
+	}
+
+	bool ReserveBypassedImport()
+	{
+		if (BypassedImportCount < BypassedImportCapacity)
+			return true;
+
+		const size_t capacity = BypassedImportCapacity ? BypassedImportCapacity * 2 : 256;
+		const HANDLE heap = GetProcessHeap();
+		void *imports = nullptr;
+
+		if (BypassedImports)
+			imports = HeapReAlloc(heap, 0, BypassedImports, capacity * sizeof(BypassedImport));
+		else
+			imports = HeapAlloc(heap, 0, capacity * sizeof(BypassedImport));
+
+		if (!imports)
+			return false;
+
+		BypassedImports = static_cast<BypassedImport *>(imports);
+		BypassedImportCapacity = capacity;
+		return true;
+	}
+
+	size_t BypassModuleImports(void *Module)
+	{
+		const auto moduleBase = reinterpret_cast<uintptr_t>(Module);
+		auto dosHeader = reinterpret_cast<const IMAGE_DOS_HEADER *>(moduleBase);
+
+		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+			return 0;
+
+		auto ntHeaders = reinterpret_cast<const IMAGE_NT_HEADERS *>(moduleBase + dosHeader->e_lfanew);
+
+		if (ntHeaders->Signature != IMAGE_NT_SIGNATURE ||
+			ntHeaders->FileHeader.SizeOfOptionalHeader < sizeof(IMAGE_OPTIONAL_HEADER))
+			return 0;
+
+		auto importDataDirectory = &ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT];
+
+		if (importDataDirectory->VirtualAddress == 0 || importDataDirectory->Size <= 0)
+			return 0;
+
+		// Slots are matched by address rather than by the imported DLL's name. That catches imports of this proxy
+		// under any file name and imports that reached it through a forwarder.
+		const auto sectionStart = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryStart);
+		const auto sectionEnd = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryEnd);
+		auto descriptor = reinterpret_cast<const IMAGE_IMPORT_DESCRIPTOR *>(moduleBase + importDataDirectory->VirtualAddress);
+		size_t count = 0;
+
+		for (; descriptor->Name != 0 && descriptor->FirstThunk != 0; descriptor++)
+		{
+			for (auto slot = reinterpret_cast<void **>(moduleBase + descriptor->FirstThunk); *slot; slot++)
+			{
+				const auto value = reinterpret_cast<uintptr_t>(*slot);
+
+				if (value < sectionStart || value >= sectionEnd)
+					continue;
+
+				const auto stub = reinterpret_cast<const Section::StubPlaceholderCode *>(value);
+
+				if (IsHookedStub(stub))
+					continue;
+
+				// Unresolved exports keep raising their error from the stub
+				const auto destination = ReadStubDestination(stub);
+
+				if (!destination || IsUnresolvedDestination(destination))
+					continue;
+
+				// Slots that can't be recorded aren't rewritten. DllProxy::Rebind would never find them again.
+				if (!ReserveBypassedImport())
+					return count;
+
+				if (!WriteImportSlot(slot, reinterpret_cast<void *>(value), destination))
+					continue;
+
+				BypassedImports[BypassedImportCount++] = { slot, stub, Module, destination };
+				count++;
+			}
+		}
+
+		return count;
+	}
+
+	size_t BypassImportTablesImpl()
+	{
+		// The module list is a snapshot. Anything loaded afterwards is picked up by the next call.
+		const HANDLE process = GetCurrentProcess();
+		const HANDLE heap = GetProcessHeap();
+		HMODULE *modules = nullptr;
+		DWORD modulesLength = 0;
+		DWORD bytesNeeded = 0;
+
+		while (K32EnumProcessModules(process, modules, modulesLength, &bytesNeeded) && bytesNeeded > modulesLength)
+		{
+			if (modules)
+				HeapFree(heap, 0, modules);
+
+			modulesLength = bytesNeeded + 16 * sizeof(HMODULE);
+			modules = static_cast<HMODULE *>(HeapAlloc(heap, 0, modulesLength));
+
+			if (!modules)
+				return 0;
+		}
+
+		if (!modules)
+			return 0;
+
+		const auto localModule = GetLocalModuleHandle();
+		const size_t moduleCount = (bytesNeeded < modulesLength ? bytesNeeded : modulesLength) / sizeof(HMODULE);
+		size_t count = 0;
+
+		// The snapshot holds no references. Pin every module before touching its headers and skip the ones that were
+		// unloaded in the meantime. Dropping the last reference runs a module's DllMain, so the pins are released
+		// after BypassLock.
+		for (size_t i = 0; i < moduleCount; i++)
+		{
+			HMODULE pinned = nullptr;
+
+			if (modules[i] == localModule ||
+				!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(modules[i]), &pinned))
+			{
+				modules[i] = nullptr;
+				continue;
+			}
+
+			// Another module was mapped at the same address
+			if (pinned != modules[i])
+			{
+				FreeLibrary(pinned);
+				modules[i] = nullptr;
+			}
+		}
+
+		AcquireSRWLockExclusive(&BypassLock);
+
+		for (size_t i = 0; i < moduleCount; i++)
+		{
+			if (modules[i])
+				count += BypassModuleImports(modules[i]);
+		}
+
+		ReleaseSRWLockExclusive(&BypassLock);
+
+		for (size_t i = 0; i < moduleCount; i++)
+		{
+			if (modules[i])
+				FreeLibrary(modules[i]);
+		}
+
+		HeapFree(heap, 0, modules);
+		return count;
+	}
+
+	// Import slots that skip a stub have to follow it when DllProxy::Rebind points it somewhere else
+	void RefreshBypassedImports()
+	{
+		AcquireSRWLockExclusive(&BypassLock);
+
+		for (size_t i = 0; i < BypassedImportCount; i++)
+		{
+			auto& import = BypassedImports[i];
+			HMODULE module = nullptr;
+
+			// Modules that were unloaded since took their import tables with them
+			if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+				reinterpret_cast<LPCWSTR>(import.Slot), &module) || module != import.Module)
+				continue;
+
+			const auto destination = ReadStubDestination(import.Stub);
+
+			// Slots rewritten by someone else since, including in between these two checks, are left alone
+			if (destination == import.Value || !WriteImportSlot(import.Slot, import.Value, destination))
+				continue;
+
+			import.Value = destination;
+		}
+
+		ReleaseSRWLockExclusive(&BypassLock);
+	}
+#endif // DLL_PROXY_IMPORT_TABLE_BYPASS
+
+#if defined(DLL_PROXY_LAZY_BINDING)
+	constinit SRWLOCK LazyPatchLock = SRWLOCK_INIT;
+
+	// RaiseErrors is false for background warm-up. Libraries that fail to load there return null and are left for
+	// the first real call to report.
+	void *GetLazyOriginalModule(uint32_t Library, bool RaiseErrors = true)
+	{
+#if defined(DLL_PROXY_DEFERRED_LIBRARY_LOAD)
+		if (!OriginalModules[Library])
+		{
+			// No lock is held across the resolver. A thread blocked on one while another thread owns the loader lock
+			// and calls into a proxy stub would deadlock. Concurrent first calls may both run the resolver. The loader
+			// hands back the same module and the first published handle wins. Each library is loaded the first time
+			// one of its own exports is called.
+			const auto& library = Section::LibraryTable[Library];
+			const auto originalModule = RaiseErrors
+				? ResolveOriginalLibrary(library)
+				: InvokeLibraryResolver(::DLL_PROXY_LIBRARY_RESOLVER_CALLBACK, library.Name);
+
+			if (!originalModule)
+				return nullptr;
+
+			// Losers drop the extra reference their resolver call took
+			if (InterlockedCompareExchangePointer(&OriginalModules[Library], originalModule, nullptr) != nullptr)
+				FreeLibrary(static_cast<HMODULE>(originalModule));
+		}
+#endif // DLL_PROXY_DEFERRED_LIBRARY_LOAD
+
+		return OriginalModules[Library];
+	}
+
+	bool IsLazyStubResolved(const Section::StubPlaceholderCode *Stub)
+	{
+#if defined(_M_IX86)
+		return Stub->JmpDwordDestination != &Stub->CallDwordOpcode;
+#elif defined(_M_X64) // _M_IX86
+		return Stub->JmpQwordDestination != &Stub->CallQwordOpcode;
+#endif // _M_X64
+	}
+
+	// Patches a stub that hasn't been resolved yet and returns its new destination. With RaiseErrors false, a library
+	// or export that can't be found returns null and leaves the stub as it was.
+	void *ResolveLazyStub(Section::StubPlaceholderCode *Stub, bool RaiseErrors)
+	{
+		const auto& entry = Section::ExportTable[Stub->ExportIndex];
+		void *functionPointer = nullptr;
+
+		for (;;)
+		{
+			const auto originalModule = GetLazyOriginalModule(entry.Library, RaiseErrors);
+
+			// Without deferred loading the module only exists once DllProxy::Initialize has run. Resolvers handed a
+			// null module would look the export up in the host executable instead.
+			if (!originalModule || !ResolveRealExport(originalModule, Stub->ExportIndex, &functionPointer))
+			{
+				if (!RaiseErrors)
+					return nullptr;
+
+				UnrecoverableError(ErrorCode::ExportNotResolved, Section::LibraryTable[entry.Library].Name);
+			}
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+			functionPointer = CollapseExportChain(originalModule, Stub->ExportIndex, functionPointer);
+#endif
+
+			// Other threads may be executing code on the same page, so it has to stay executable. The lock keeps
+			// concurrent first calls from restoring each other's protection while a write is in flight. Resolution
+			// happens outside of it since resolvers may take the loader lock.
+			AcquireSRWLockExclusive(&LazyPatchLock);
+
+			// DllProxy::Rebind swapped the module while this export was being resolved. Start over with the new one.
+			if (OriginalModules[entry.Library] == originalModule)
+				break;
+
+			ReleaseSRWLockExclusive(&LazyPatchLock);
+		}
+
+		const auto destination = ApplyExportHook(Stub->ExportIndex, functionPointer);
+
+		{
+			DWORD oldProtection = 0;
+
+			if (!VirtualProtect(Stub, sizeof(*Stub), PAGE_EXECUTE_READWRITE, &oldProtection))
+				UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
+			PatchStubDestination(Stub, destination);
+
+			if (!VirtualProtect(Stub, sizeof(*Stub), oldProtection, &oldProtection))
+				UnrecoverableError(ErrorCode::VirtualProtectFailed);
+		}
+		ReleaseSRWLockExclusive(&LazyPatchLock);
+
+		FlushInstructionCache(GetCurrentProcess(), Stub, sizeof(*Stub));
+		return destination;
+	}
+
+	// Called from XPROXY_LazyResolverThunk the first time a stub is invoked. Returns the address to tail jump to.
+	void *__cdecl LazyResolveStub(void *Stub)
+	{
+		return ResolveLazyStub(static_cast<Section::StubPlaceholderCode *>(Stub), true);
+	}
+
+#if defined(DLL_PROXY_BACKGROUND_WARMUP)
+	// Queued by DllProxy::Initialize. Library resolvers block on the loader lock, so this can't get anywhere until
+	// the load that triggered initialization has finished. Stubs called in the meantime resolve themselves through
+	// LazyResolveStub and are skipped here.
+	void CALLBACK WarmUpCallback(PTP_CALLBACK_INSTANCE Instance, PVOID Context)
+	{
+		constinit static std::array<void *, Section::ExportCount> resolvedPointers {};
+		constinit static std::array<void *, Section::LibraryCount> resolvedModules {};
+
+		resolvedPointers.fill(nullptr);
+
+		// Resolve everything before taking the patch lock. A first call made under the loader lock would wait on
+		// it while this thread waits on the loader lock inside a resolver.
+		for (uint32_t i = 0; i < Section::LibraryCount; i++)
+		{
+			const auto& library = Section::LibraryTable[i];
+			const auto originalModule = GetLazyOriginalModule(i, false);
+
+			resolvedModules[i] = originalModule;
+
+			// A thread pool thread has nobody to report LibraryNotFound to. The library's exports stay unresolved and
+			// the first call to one of them raises the error instead.
+			if (!originalModule)
+				continue;
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER)
+			ResolveExportsFromDirectory(originalModule, library, resolvedPointers);
+#else
+			for (uint32_t j = library.FirstExport; j < library.FirstExport + library.ExportCount; j++)
+			{
+				const auto& entry = Section::ExportTable[j];
+
+				if (!IsLazyStubResolved(entry.Stub))
+					ResolveRealExport(originalModule, j, &resolvedPointers[j]);
+			}
+#endif
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+			for (uint32_t j = library.FirstExport; j < library.FirstExport + library.ExportCount; j++)
+			{
+				if (resolvedPointers[j] && !IsLazyStubResolved(Section::ExportTable[j].Stub))
+					resolvedPointers[j] = CollapseExportChain(originalModule, j, resolvedPointers[j]);
+			}
+#endif
+		}
+
+		// Then patch every stub that's still unresolved in a single pass. Unresolved exports are left alone and
+		// report their error when they're called, same as they would without warm-up.
+		const auto sectionStart = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryStart);
+		const auto sectionEnd = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryEnd);
+		const auto sectionLength = sectionEnd - sectionStart;
+
+		AcquireSRWLockExclusive(&LazyPatchLock);
+		{
+			DWORD oldProtection = 0;
+
+			if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, PAGE_EXECUTE_READWRITE, &oldProtection))
+				UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
+			for (size_t i = 0; i < Section::ExportCount; i++)
+			{
+				const auto& entry = Section::ExportTable[i];
+
+				// Libraries rebound in the meantime are left to resolve against their new module on first call
+				if (OriginalModules[entry.Library] != resolvedModules[entry.Library])
+					continue;
+
+				if (resolvedPointers[i] && !IsLazyStubResolved(entry.Stub))
+					PatchStubDestination(entry.Stub, ApplyExportHook(i, resolvedPointers[i]));
+			}
+
+			if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, oldProtection, &oldProtection))
+				UnrecoverableError(ErrorCode::VirtualProtectFailed);
+		}
+		ReleaseSRWLockExclusive(&LazyPatchLock);
+
+		FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<void *>(sectionStart), sectionLength);
+
+		// Drop the reference taken in InitializeImpl once this callback is no longer running code from this module
+		FreeLibraryWhenCallbackReturns(Instance, static_cast<HMODULE>(Context));
+	}
+#endif // DLL_PROXY_BACKGROUND_WARMUP
+#endif // DLL_PROXY_LAZY_BINDING
+
+	// Backs DllProxy::Real. Hooked exports jump to their hook, so the real function comes from DllProxy::Original.
+	template<size_t ExportIndex>
+	void *ReadRealFunction()
+	{
+		constexpr auto hook = Section::Listing.Hooks[ExportIndex];
+		const auto stub = Section::ExportTable[ExportIndex].Stub;
+
+#if defined(DLL_PROXY_LAZY_BINDING)
+		// Same as the first call through the stub, except that failures return nullptr instead of raising an error
+		if (!IsLazyStubResolved(stub) && !ResolveLazyStub(stub, false))
+			return nullptr;
+#endif // DLL_PROXY_LAZY_BINDING
+
+		if constexpr (hook != nullptr)
+		{
+			return *static_cast<void *const *>(hook->Original);
+		}
+		else
+		{
+			const auto destination = ReadStubDestination(stub);
+
+			if (IsUnresolvedDestination(destination))
+				return nullptr;
+
+			return destination;
+		}
+	}
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+	constexpr uint32_t TraceRecordsPerThread = DLL_PROXY_TRACE_RECORDS_PER_THREAD;
+	constexpr uint32_t TraceMaxDepth = 64;
+
+	static_assert(TraceRecordsPerThread != 0 && (TraceRecordsPerThread & (TraceRecordsPerThread - 1)) == 0,
+		"DLL_PROXY_TRACE_RECORDS_PER_THREAD must be a power of two");
+
+	struct TraceShadowFrame
+	{
+		void **ReturnSlot;
+		void *ReturnAddress;
+		uint32_t ExportIndex;
+		uint64_t EnterTimestamp;
+	};
+
+	// Only the owning thread writes to a buffer. Dumps read RecordsWritten and copy whatever the ring holds, so
+	// records written during a dump may be torn.
+	struct TraceThreadBuffer
+	{
+		TraceThreadBuffer *Next;
+		uint32_t ThreadId;
+		uint32_t Depth;
+		volatile LONG RecordsWritten;
+		volatile LONG AbandonedCalls; // Frames discarded because their call never returned through the thunk
+		TraceShadowFrame Frames[TraceMaxDepth];
+		Trace::Record Records[TraceRecordsPerThread];
+	};
+
+	constinit DWORD TraceTlsIndex = TLS_OUT_OF_INDEXES;
+	constinit void *TraceBufferList = nullptr;
+	constinit uint64_t TraceStartCounter = 0;
+	constinit uint64_t TraceStartTimestamp = 0;
+
+#if defined(_M_X64)
+	constinit void *TraceExceptionHandler = nullptr;
+
+	// x64 unwinding reads return addresses off the stack and XPROXY_TraceLeaveThunk has no unwind info. Swapped return
+	// addresses are put back before any frame based handler walks the stack. Those calls aren't recorded, including
+	// ones whose callee handles the exception itself and returns normally. Their frames are discarded and counted once
+	// the stack moves past them. x86 unwinding follows the SEH chain instead.
+	LONG CALLBACK TraceExceptionCallback(PEXCEPTION_POINTERS ExceptionInfo)
+	{
+		const DWORD lastError = GetLastError();
+		const auto buffer = static_cast<TraceThreadBuffer *>(TlsGetValue(TraceTlsIndex));
+		const auto stackPointer = reinterpret_cast<void **>(ExceptionInfo->ContextRecord->Rsp);
+
+		// Outermost first. A traced export that tail called another one shares its caller's slot.
+		for (uint32_t i = 0; buffer && i < buffer->Depth; i++)
+		{
+			const auto& frame = buffer->Frames[i];
+
+			if (frame.ReturnSlot >= stackPointer && *frame.ReturnSlot == &Section::XPROXY_TraceLeaveThunk)
+				*frame.ReturnSlot = frame.ReturnAddress;
+		}
+
+		SetLastError(lastError);
+		return EXCEPTION_CONTINUE_SEARCH;
+	}
+#endif // _M_X64
+
+	// Returning through XPROXY_TraceLeaveThunk doesn't match the CET shadow stack and raises #CP. Stubs in processes
+	// that enforce user shadow stacks call straight through without tracing.
+	bool IsUserShadowStackEnabled()
+	{
+		using PfnGetProcessMitigationPolicy = BOOL(WINAPI *)(HANDLE, PROCESS_MITIGATION_POLICY, PVOID, SIZE_T);
+
+		// Avoid a hard dependency on Windows 8. Shadow stacks need Windows 10 regardless.
+		const auto getMitigationPolicy = reinterpret_cast<PfnGetProcessMitigationPolicy>(
+			GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetProcessMitigationPolicy"));
+		PROCESS_MITIGATION_USER_SHADOW_STACK_POLICY policy {};
+
+		if (!getMitigationPolicy || !getMitigationPolicy(GetCurrentProcess(), ProcessUserShadowStackPolicy, &policy, sizeof(policy)))
+			return false;
+
+		return policy.EnableUserShadowStack != 0;
+	}
+
+	void InitializeTracing()
+	{
+		if (TraceTlsIndex == TLS_OUT_OF_INDEXES && !IsUserShadowStackEnabled())
+		{
+			TraceTlsIndex = TlsAlloc();
+
+#if defined(_M_X64)
+			if (TraceTlsIndex != TLS_OUT_OF_INDEXES)
+			{
+				TraceExceptionHandler = AddVectoredExceptionHandler(TRUE, TraceExceptionCallback);
+
+				// Without the handler an exception would unwind into the thunk. Leave tracing off instead.
+				if (!TraceExceptionHandler)
+				{
+					TlsFree(TraceTlsIndex);
+					TraceTlsIndex = TLS_OUT_OF_INDEXES;
+				}
+			}
+#endif // _M_X64
+		}
+
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+
+		TraceStartCounter = counter.QuadPart;
+		TraceStartTimestamp = __rdtsc();
+	}
+
+	// Thread buffers stay allocated so a dump written afterwards still has them
+	void ShutdownTracing()
+	{
+#if defined(_M_X64)
+		if (TraceExceptionHandler)
+		{
+			RemoveVectoredExceptionHandler(TraceExceptionHandler);
+			TraceExceptionHandler = nullptr;
+		}
+#endif // _M_X64
+
+		if (TraceTlsIndex != TLS_OUT_OF_INDEXES)
+		{
+			TlsFree(TraceTlsIndex);
+			TraceTlsIndex = TLS_OUT_OF_INDEXES;
+		}
+	}
+
+	TraceThreadBuffer *GetTraceThreadBuffer()
+	{
+		if (TraceTlsIndex == TLS_OUT_OF_INDEXES)
+			return nullptr;
+
+		auto buffer = static_cast<TraceThreadBuffer *>(TlsGetValue(TraceTlsIndex));
+
+		if (!buffer)
+		{
+			buffer = static_cast<TraceThreadBuffer *>(VirtualAlloc(nullptr, sizeof(TraceThreadBuffer), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+
+			// Tracing is best effort. Calls still go through if memory runs out.
+			if (!buffer)
+				return nullptr;
+
+			buffer->ThreadId = GetCurrentThreadId();
+			TlsSetValue(TraceTlsIndex, buffer);
+
+			// Buffers are never freed so threads that already exited still show up in dumps
+			do
+			{
+				buffer->Next = static_cast<TraceThreadBuffer *>(TraceBufferList);
+			} while (InterlockedCompareExchangePointer(&TraceBufferList, buffer, buffer->Next) != buffer->Next);
+		}
+
+		return buffer;
+	}
+
+	// Called from XPROXY_TraceEnterThunk on every call. Swaps the caller's return address for XPROXY_TraceLeaveThunk
+	// and returns the address to tail jump to.
+	void *__cdecl TraceEnter(void *Stub, void **ReturnSlot)
+	{
+		const auto stub = static_cast<Section::StubPlaceholderCode *>(Stub);
+		const DWORD lastError = GetLastError();
+
+		if (const auto buffer = GetTraceThreadBuffer())
+		{
+			// Frames at or below this call's return slot belong to calls that never came back through the thunk, e.g.
+			// after a longjmp or a caught exception. The only live frame sharing the slot is a traced export that tail
+			// called this one, which left the thunk in it.
+			while (buffer->Depth > 0)
+			{
+				const auto slot = buffer->Frames[buffer->Depth - 1].ReturnSlot;
+
+				if (slot > ReturnSlot || (slot == ReturnSlot && *ReturnSlot == &Section::XPROXY_TraceLeaveThunk))
+					break;
+
+				buffer->Depth--;
+				InterlockedIncrement(&buffer->AbandonedCalls);
+			}
+
+			if (buffer->Depth < TraceMaxDepth)
+			{
+				auto& frame = buffer->Frames[buffer->Depth++];
+
+				frame.ReturnSlot = ReturnSlot;
+				frame.ReturnAddress = *ReturnSlot;
+				frame.ExportIndex = stub->ExportIndex;
+				*ReturnSlot = &Section::XPROXY_TraceLeaveThunk;
+				frame.EnterTimestamp = __rdtsc();
+			}
+		}
+
+		SetLastError(lastError);
+
+#if defined(_M_IX86)
+		return stub->JmpDwordDestination;
+#elif defined(_M_X64) // _M_IX86
+		return stub->JmpQwordDestination;
+#endif // _M_X64
+	}
+
+	// Called from XPROXY_TraceLeaveThunk when a traced call returns. Returns the caller's original return address.
+	void *__cdecl TraceLeave(void **StackPointer)
+	{
+		const uint64_t leaveTimestamp = __rdtsc();
+		const DWORD lastError = GetLastError();
+		const auto buffer = static_cast<TraceThreadBuffer *>(TlsGetValue(TraceTlsIndex));
+
+		// The ret that got here popped the swapped slot. Deeper frames were abandoned without returning.
+		const auto returnSlot = StackPointer - 1;
+
+		while (buffer && buffer->Depth > 0 && buffer->Frames[buffer->Depth - 1].ReturnSlot < returnSlot)
+		{
+			buffer->Depth--;
+			InterlockedIncrement(&buffer->AbandonedCalls);
+		}
+
+		// There's no way to know where to return to
+		if (!buffer || buffer->Depth == 0 || buffer->Frames[buffer->Depth - 1].ReturnSlot != returnSlot)
+			UnrecoverableError(ErrorCode::TraceStackMismatch);
+
+		const auto& frame = buffer->Frames[--buffer->Depth];
+		auto& record = buffer->Records[static_cast<uint32_t>(buffer->RecordsWritten) & (TraceRecordsPerThread - 1)];
+
+		record.ExportIndex = frame.ExportIndex;
+		record.ThreadId = buffer->ThreadId;
+		record.EnterTimestamp = frame.EnterTimestamp;
+		record.LeaveTimestamp = leaveTimestamp;
+		InterlockedIncrement(&buffer->RecordsWritten);
 
-		__debugbreak();
-#if defined(_MSC_VER)
-		__assume(0);
-#elif defined(__GNUC__)
-		__builtin_unreachable();
-#endif
+		SetLastError(lastError);
+		return frame.ReturnAddress;
 	}
 
-	void UnresolvedExportCallback()
+	bool WriteTraceBytes(HANDLE File, const void *Data, size_t Length)
 	{
-		UnrecoverableError(ErrorCode::ExportNotResolved);
+		DWORD bytesWritten = 0;
+		return WriteFile(File, Data, static_cast<DWORD>(Length), &bytesWritten, nullptr) && bytesWritten == Length;
 	}
 
-	void WINAPI TLSInitCallback(PVOID DllHandle, DWORD Reason, PVOID Reserved)
+	bool WriteTraceDumpImpl(HANDLE File)
 	{
-		if (Reason == DLL_PROCESS_ATTACH)
-			InitializeImpl();
-	}
+		Trace::FileHeader header {};
 
-	__declspec(noinline) void *GetLocalModuleHandle()
-	{
-		constinit static void *moduleHandle = nullptr;
+		for (size_t i = 0; i < sizeof(header.Magic); i++)
+			header.Magic[i] = Trace::FileMagic[i];
 
-		if (!moduleHandle)
+		header.Version = Trace::FileVersion;
+		header.ExportCount = static_cast<uint32_t>(Section::ExportCount);
+
+		// Written twice. The record count isn't known until every ring has been copied.
+		if (!WriteTraceBytes(File, &header, sizeof(header)))
+			return false;
+
+		for (const auto& entry : Section::ExportTable)
 		{
-			uint32_t flags = GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT;
-			HMODULE handle = nullptr;
+			Trace::ExportEntry exportEntry { entry.Ordinal, 0 };
 
-			if (!GetModuleHandleExW(flags, reinterpret_cast<LPCWSTR>(&GetLocalModuleHandle), &handle))
-				UnrecoverableError(ErrorCode::InvalidModuleBase);
+			while (entry.Name[exportEntry.NameLength])
+				exportEntry.NameLength++;
 
-			InterlockedExchangePointer(&moduleHandle, handle);
+			if (!WriteTraceBytes(File, &exportEntry, sizeof(exportEntry)) || !WriteTraceBytes(File, entry.Name, exportEntry.NameLength))
+				return false;
 		}
 
-		return moduleHandle;
-	}
+		for (auto buffer = static_cast<TraceThreadBuffer *>(TraceBufferList); buffer; buffer = buffer->Next)
+		{
+			const auto written = static_cast<uint32_t>(buffer->RecordsWritten);
+			const uint32_t count = written < TraceRecordsPerThread ? written : TraceRecordsPerThread;
+			const uint32_t first = (written - count) & (TraceRecordsPerThread - 1);
+			const uint32_t firstLength = count < TraceRecordsPerThread - first ? count : TraceRecordsPerThread - first;
 
-	template<typename T>
-	T ConvertModuleRva(uintptr_t Rva)
-	{
-		return (T)(reinterpret_cast<uintptr_t>(GetLocalModuleHandle()) + Rva);
+			// Oldest records first. The ring may wrap once.
+			if (!WriteTraceBytes(File, &buffer->Records[first], firstLength * sizeof(Trace::Record)) ||
+				!WriteTraceBytes(File, &buffer->Records[0], (count - firstLength) * sizeof(Trace::Record)))
+				return false;
+
+			header.RecordCount += count;
+			header.AbandonedCount += static_cast<uint32_t>(buffer->AbandonedCalls);
+		}
+
+		LARGE_INTEGER counter;
+		LARGE_INTEGER frequency;
+		QueryPerformanceCounter(&counter);
+		QueryPerformanceFrequency(&frequency);
+
+		header.CounterFrequency = frequency.QuadPart;
+		header.StartCounter = TraceStartCounter;
+		header.StartTimestamp = TraceStartTimestamp;
+		header.EndCounter = counter.QuadPart;
+		header.EndTimestamp = __rdtsc();
+
+		if (SetFilePointer(File, 0, nullptr, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
+			return false;
+
+		return WriteTraceBytes(File, &header, sizeof(header));
 	}
+#endif // DLL_PROXY_ENABLE_CALL_TRACING
 
-	// Pass the callback as a templated type to avoid the need for std::function's allocations
-	template<typename T>
-	requires(std::is_invocable_v<T, uint32_t /* Ordinal */, const char */* Name */, uintptr_t /* Address */>)
-	void EnumerateLocalModuleExports(T&& Callback)
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+	// Filled in as InitializeImpl goes. It's static so DllProxy::GetInitReport can be called from the TLS callback,
+	// or from an exception callback that was raised halfway through initialization.
+	constinit InitReport InitReportData {};
+
+	int64_t ReadInitCounter()
 	{
-		auto dosHeader = ConvertModuleRva<const IMAGE_DOS_HEADER *>(0);
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
 
-		if (dosHeader->e_magic != IMAGE_DOS_SIGNATURE)
-			UnrecoverableError(ErrorCode::InvalidModuleHeaders);
+		return counter.QuadPart;
+	}
 
-		auto ntHeaders = ConvertModuleRva<const IMAGE_NT_HEADERS *>(dosHeader->e_lfanew);
+	void RecordExportResolution(size_t ExportIndex, bool Status, const void *FunctionPointer, int64_t Ticks)
+	{
+		auto& report = InitReportData;
+		const auto& entry = Section::ExportTable[ExportIndex];
 
-		if (ntHeaders->Signature != IMAGE_NT_SIGNATURE ||
-			ntHeaders->FileHeader.SizeOfOptionalHeader < sizeof(IMAGE_OPTIONAL_HEADER))
-			UnrecoverableError(ErrorCode::InvalidModuleHeaders);
+		if (!Status)
+			report.MissingExports++;
+		else if (!FunctionPointer)
+			report.NullExports++;
+		else
+			report.ResolvedExports++;
 
-		auto exportDataDirectory = &ntHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
-		auto exportDirectory = ConvertModuleRva<const IMAGE_EXPORT_DIRECTORY *>(exportDataDirectory->VirtualAddress);
+		report.ExportResolveTicks += Ticks;
 
-		if (exportDataDirectory->VirtualAddress == 0 || exportDataDirectory->Size <= 0)
-			UnrecoverableError(ErrorCode::InvalidModuleHeaders);
+		// Insertion into a short list kept sorted from slowest to fastest
+		constexpr uint32_t capacity = ARRAYSIZE(report.SlowestExports);
+		uint32_t position = report.SlowestExportCount;
 
-		auto exportAddressTable = ConvertModuleRva<const uint32_t *>(exportDirectory->AddressOfFunctions);
-		auto exportNameTable = ConvertModuleRva<const uint32_t *>(exportDirectory->AddressOfNames);
-		auto exportNameOrdinalTable = ConvertModuleRva<const uint16_t *>(exportDirectory->AddressOfNameOrdinals);
+		if (position == capacity)
+		{
+			if (Ticks <= report.SlowestExports[capacity - 1].Ticks)
+				return;
 
-		// Ordinals are just an index. Names might not be present.
-		for (uint32_t i = 0; i < exportDirectory->NumberOfFunctions; i++)
+			position--;
+		}
+		else
 		{
-			const uint32_t exportOrdinal = exportDirectory->Base + i;
-			const auto exportName = [&]() -> const char *
-			{
-				for (uint32_t j = 0; j < exportDirectory->NumberOfNames; j++)
-				{
-					if (exportNameOrdinalTable[j] == i)
-						return ConvertModuleRva<const char *>(exportNameTable[j]);
-				}
+			report.SlowestExportCount++;
+		}
 
-				return nullptr;
-			}();
+		for (; position > 0 && report.SlowestExports[position - 1].Ticks < Ticks; position--)
+			report.SlowestExports[position] = report.SlowestExports[position - 1];
 
-			Callback(exportOrdinal, exportName, ConvertModuleRva<uintptr_t>(exportAddressTable[i]));
-		}
+		report.SlowestExports[position] = { entry.Name, entry.Ordinal, Ticks };
 	}
+#endif // DLL_PROXY_ENABLE_INIT_REPORT
 
 	void InitializeImpl()
 	{
-		// Load the original DLL. If it's not available, we can't do anything.
-		const auto originalModule = RealLibraryResolver();
+#if defined(DLL_PROXY_DEFERRED_LIBRARY_LOAD)
+#if defined(DLL_PROXY_BACKGROUND_WARMUP)
+		// Stubs are already armed to resolve themselves. Hand bulk resolution to the thread pool once and keep this
+		// module loaded until it's done. Failing to queue it only means every stub resolves on its first call.
+		constinit static volatile LONG warmUpQueued = 0;
+		HMODULE moduleHandle = nullptr;
+
+		if (InterlockedExchange(&warmUpQueued, 1) == 0 &&
+			GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&WarmUpCallback), &moduleHandle))
+		{
+			if (!TrySubmitThreadpoolCallback(WarmUpCallback, moduleHandle, nullptr))
+				FreeLibrary(moduleHandle);
+		}
+#endif
+
+		// The original DLL is loaded by the first stub that gets called or by the warm-up callback. There's nothing
+		// else to do here.
+#else
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		LARGE_INTEGER counterFrequency;
+		QueryPerformanceFrequency(&counterFrequency);
+
+		InitReportData = {};
+		InitReportData.CounterFrequency = counterFrequency.QuadPart;
+
+		const auto initStart = ReadInitCounter();
+		auto phaseStart = initStart;
+#endif
+
+		// Load every original DLL. If one isn't available, we can't do anything.
+		for (size_t i = 0; i < Section::LibraryCount; i++)
+			InterlockedExchangePointer(&OriginalModules[i], ResolveOriginalLibrary(Section::LibraryTable[i]));
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.LibraryResolveTicks = ReadInitCounter() - phaseStart;
+#endif
 
-		if (!originalModule)
-			UnrecoverableError(ErrorCode::LibraryNotFound);
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+		InitializeTracing();
+#endif
 
+#if defined(DLL_PROXY_LAZY_BINDING)
+		// Stubs resolve and patch themselves the first time they're called
+#else
+#if !defined(DLL_PROXY_READ_ONLY_STUBS)
 		// Then unprotect the entire proxy segment for writing
 		const auto sectionStart = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryStart);
 		const auto sectionEnd = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryEnd);
 		const auto sectionLength = sectionEnd - sectionStart;
 		DWORD oldProtection = 0;
 
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		phaseStart = ReadInitCounter();
+#endif
+
 		if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, PAGE_READWRITE, &oldProtection))
 			UnrecoverableError(ErrorCode::VirtualProtectFailed);
 
-		// Iterate over all exports from this DLL. If the RVA points into the dllprox section, patch the jump to
-		// point back to the original library.
-		EnumerateLocalModuleExports([&](uint32_t Ordinal, const char *Name, uintptr_t Address)
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.VirtualProtectTicks += ReadInitCounter() - phaseStart;
+#endif
+#endif // !DLL_PROXY_READ_ONLY_STUBS
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) || defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+		constinit static std::array<void *, Section::ExportCount> resolvedPointers {};
+
+		resolvedPointers.fill(nullptr);
+#endif
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		phaseStart = ReadInitCounter();
+#endif
+
+		ResolutionCacheView cacheView;
+		const auto cache = MapResolutionCache(cacheView);
+		bool cacheStale = !cache;
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.HeaderWalkTicks += ReadInitCounter() - phaseStart;
+#endif
+#endif
+
+		// Iterate over the compile-time export table one library at a time and patch each stub's jump to point back
+		// to the original library that the listing grouped it under
+		for (size_t i = 0; i < Section::LibraryCount; i++)
 		{
-			if (Address > sectionStart && Address < sectionEnd)
+			const auto& library = Section::LibraryTable[i];
+			const auto originalModule = OriginalModules[i];
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT) && (defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) || defined(DLL_PROXY_RESOLUTION_CACHE_PATH))
+			phaseStart = ReadInitCounter();
+#endif
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+			// Cached RVAs replace lookups by name when this is the exact module they were taken from
+			const bool libraryCached = cache && ReadCachedExports(*cache, i, originalModule, resolvedPointers);
+			cacheStale |= !libraryCached;
+#elif defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER)
+			constexpr bool libraryCached = false;
+#endif
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER)
+			if (!libraryCached)
+				ResolveExportsFromDirectory(originalModule, library, resolvedPointers);
+#endif
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT) && (defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) || defined(DLL_PROXY_RESOLUTION_CACHE_PATH))
+			InitReportData.HeaderWalkTicks += ReadInitCounter() - phaseStart;
+#endif
+
+			for (size_t j = library.FirstExport; j < library.FirstExport + library.ExportCount; j++)
 			{
+				const auto& entry = Section::ExportTable[j];
 				void *functionPointer = nullptr;
-				const bool status = RealExportResolver(originalModule, Ordinal, Name, &functionPointer);
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+				const auto resolveStart = ReadInitCounter();
+#endif
+
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER) || defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+				functionPointer = resolvedPointers[j];
+				bool status = functionPointer != nullptr;
+
+				// Anything the cache couldn't hold still goes through the resolver. A directory pass already covered
+				// every export of libraries that weren't cached.
+#if defined(DLL_PROXY_EXPORT_DIRECTORY_RESOLVER)
+				if (!status && libraryCached)
+#else
+				if (!status)
+#endif
+					status = ResolveRealExport(originalModule, j, &functionPointer);
+#else
+				const bool status = ResolveRealExport(originalModule, j, &functionPointer);
+#endif
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+				RecordExportResolution(j, status, functionPointer, ReadInitCounter() - resolveStart);
+#endif
 
 #if defined(DLL_PROXY_CHECK_MISSING_EXPORTS)
 				if (!status)
-					UnrecoverableError(ErrorCode::ExportNotFound);
+					UnrecoverableError(ErrorCode::ExportNotFound, library.Name);
 #endif
 
 				// functionPointer is allowed to be null as long as success is reported. Users can hurt themselves as they please.
 				if (status)
 				{
-#if defined(_M_IX86)
-					auto ptr = &reinterpret_cast<Section::X86StubPlaceholderCode *>(Address)->JmpDwordDestination;
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+					// The cache keeps the resolver's own result
+					const auto destination = ApplyExportHook(j, CollapseExportChain(originalModule, j, functionPointer));
+#else
+					const auto destination = ApplyExportHook(j, functionPointer);
+#endif
 
-					static_assert(sizeof(*ptr) == sizeof(LONG), "Expected pointer to be 32 bits");
-					InterlockedExchange(reinterpret_cast<LONG *>(ptr), reinterpret_cast<LONG>(functionPointer));
-#elif defined(_M_X64) // _M_IX86
-					auto __unaligned ptr = &reinterpret_cast<Section::Amd64StubPlaceholderCode *>(Address)->JmpQwordDestination;
+					PatchStubDestination(entry.Stub, destination);
 
-					static_assert(sizeof(*ptr) == sizeof(LONGLONG), "Expected pointer to be 64 bits");
-					InterlockedExchange64(reinterpret_cast<LONGLONG *>(ptr), reinterpret_cast<LONGLONG>(functionPointer));
-#endif // _M_X64
+#if defined(DLL_PROXY_DIRECT_JUMP_PATCHING)
+					if (destination)
+						PatchStubDirectJump(entry.Stub, destination);
+#endif
+				}
+#if defined(DLL_PROXY_POSITION_INDEPENDENT_STUBS) && !defined(__GNUC__)
+				else
+				{
+					// MSVC stubs start out failing fast rather than at the unresolved export thunk, so missing
+					// exports are pointed at the callback here
+					PatchStubDestination(entry.Stub, reinterpret_cast<void *>(&UnresolvedExportCallback));
 				}
+#endif
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+				resolvedPointers[j] = status ? functionPointer : nullptr;
+#endif
 			}
-		});
+		}
+
+#if !defined(DLL_PROXY_READ_ONLY_STUBS)
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		phaseStart = ReadInitCounter();
+#endif
 
 		// Reprotect. Done.
 		if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, oldProtection, &oldProtection))
 			UnrecoverableError(ErrorCode::VirtualProtectFailed);
 
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.VirtualProtectTicks += ReadInitCounter() - phaseStart;
+		phaseStart = ReadInitCounter();
+#endif
+
+		FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<void *>(sectionStart), sectionLength);
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.FlushTicks = ReadInitCounter() - phaseStart;
+#endif
+#endif // !DLL_PROXY_READ_ONLY_STUBS
+
+#if defined(DLL_PROXY_RESOLUTION_CACHE_PATH)
+		UnmapResolutionCache(cacheView);
+
+		if (cacheStale)
+			WriteResolutionCache(OriginalModules, resolvedPointers);
+#endif
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+		// Stubs hold their final destinations now. Importers that were already bound can skip them.
+		BypassImportTablesImpl();
+#endif
+#endif // DLL_PROXY_LAZY_BINDING
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+		InitReportData.TotalTicks = ReadInitCounter() - initStart;
+#endif
+#endif // DLL_PROXY_DEFERRED_LIBRARY_LOAD
+	}
+
+	bool RebindImpl(void *NewModule, const wchar_t *LibraryName, void **PreviousModule)
+	{
+		if (!NewModule)
+			return false;
+
+		uint32_t libraryIndex = 0;
+
+		if (LibraryName)
+		{
+			while (libraryIndex < Section::LibraryCount && lstrcmpiW(Section::LibraryTable[libraryIndex].Name, LibraryName) != 0)
+				libraryIndex++;
+
+			if (libraryIndex == Section::LibraryCount)
+				return false;
+		}
+
+		const auto& library = Section::LibraryTable[libraryIndex];
+		const uint32_t firstExport = library.FirstExport;
+		const uint32_t lastExport = library.FirstExport + library.ExportCount;
+
+		constinit static SRWLOCK rebindLock = SRWLOCK_INIT;
+		constinit static std::array<void *, Section::ExportCount> reboundPointers {};
+
+		AcquireSRWLockExclusive(&rebindLock);
+
+		// Resolve the whole library before touching a single stub. Nothing is published unless the new module
+		// provides every export.
+		bool status = true;
+
+		for (uint32_t i = firstExport; status && i < lastExport; i++)
+		{
+			reboundPointers[i] = nullptr;
+			status = ResolveRealExport(NewModule, i, &reboundPointers[i]);
+		}
+
+		if (!status)
+		{
+			ReleaseSRWLockExclusive(&rebindLock);
+			return false;
+		}
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+		for (uint32_t i = firstExport; i < lastExport; i++)
+			reboundPointers[i] = CollapseExportChain(NewModule, i, reboundPointers[i]);
+#endif
+
+#if defined(DLL_PROXY_LAZY_BINDING)
+		AcquireSRWLockExclusive(&LazyPatchLock);
+#endif
+
+#if !defined(DLL_PROXY_READ_ONLY_STUBS)
+		// Other threads keep calling through the stubs while they're rewritten, so the section stays executable
+		const auto sectionStart = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryStart);
+		const auto sectionEnd = reinterpret_cast<uintptr_t>(&Section::ExportBoundaryEnd);
+		const auto sectionLength = sectionEnd - sectionStart;
+		DWORD oldProtection = 0;
+
+		if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, PAGE_EXECUTE_READWRITE, &oldProtection))
+			UnrecoverableError(ErrorCode::VirtualProtectFailed);
+#endif // !DLL_PROXY_READ_ONLY_STUBS
+
+		const auto previousModule = InterlockedExchangePointer(&OriginalModules[libraryIndex], NewModule);
+
+		// Every destination is replaced with a single locked store, so a racing caller lands in either the old or
+		// the new function
+		for (uint32_t i = firstExport; i < lastExport; i++)
+		{
+			const auto& entry = Section::ExportTable[i];
+
+#if defined(DLL_PROXY_LAZY_BINDING)
+			// Stubs that were never called resolve against the new module on their first call
+			if (!IsLazyStubResolved(entry.Stub))
+				continue;
+#endif
+
+			const auto destination = ApplyExportHook(i, reboundPointers[i]);
+
+			PatchStubDestination(entry.Stub, destination);
+
+#if defined(DLL_PROXY_DIRECT_JUMP_PATCHING)
+			if (destination)
+				PatchStubDirectJump(entry.Stub, destination);
+#endif
+		}
+
+#if !defined(DLL_PROXY_READ_ONLY_STUBS)
+		if (!VirtualProtect(reinterpret_cast<void *>(sectionStart), sectionLength, oldProtection, &oldProtection))
+			UnrecoverableError(ErrorCode::VirtualProtectFailed);
+
 		FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<void *>(sectionStart), sectionLength);
+#endif // !DLL_PROXY_READ_ONLY_STUBS
+
+#if defined(DLL_PROXY_LAZY_BINDING)
+		ReleaseSRWLockExclusive(&LazyPatchLock);
+#endif
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+		RefreshBypassedImports();
+#endif
+
+		ReleaseSRWLockExclusive(&rebindLock);
+
+		// The previous module is left loaded. Threads may still be running code in it.
+		if (PreviousModule)
+			*PreviousModule = previousModule;
+
+		return true;
 	}
 }
 
@@ -380,11 +4146,11 @@ namespace DllProxy
 	}
 #endif
 
-	void *DefaultLibraryResolverCallback()
+	void *DefaultLibraryResolverCallback(const wchar_t *LibraryName)
 	{
 		// Try to load the DLL with the user-specified path. In the event it's not found, there's nothing left to
 		// do here.
-		HMODULE libraryHandle = LoadLibraryW(Section::OriginalLibraryName);
+		HMODULE libraryHandle = LoadLibraryW(LibraryName);
 
 		if (!libraryHandle)
 			return nullptr;
@@ -408,7 +4174,7 @@ namespace DllProxy
 			}
 
 			wcscat_s(buffer, bufferLength, L"\\");
-			wcscat_s(buffer, bufferLength, Section::OriginalLibraryName);
+			wcscat_s(buffer, bufferLength, LibraryName);
 
 			libraryHandle = LoadLibraryW(buffer);
 			VirtualFree(buffer, 0, MEM_RELEASE);
@@ -417,6 +4183,20 @@ namespace DllProxy
 		return libraryHandle;
 	}
 
+	bool Rebind(void *NewModule, const wchar_t *LibraryName, void **PreviousModule)
+	{
+		return Internal::RebindImpl(NewModule, LibraryName, PreviousModule);
+	}
+
+	template<ExportName Name, typename T>
+	T Real()
+	{
+		constexpr size_t index = Section::ExportIndexOf<Name>;
+
+		static_assert(index < Section::ExportCount, "DllProxy::Real names an export that isn't in DLL_PROXY_EXPORT_LISTING_FILE.");
+		return reinterpret_cast<T>(Internal::ReadRealFunction<index>());
+	}
+
 	bool DefaultExportResolverCallback(void *Module, uint32_t Ordinal, const char *Name, void **FunctionPointer)
 	{
 		void *pointer = nullptr;
@@ -424,7 +4204,8 @@ namespace DllProxy
 		if (Name)
 			pointer = reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(Module), Name));
 
-		if (!pointer)
+		// Ordinal 0 means the listing only declared a name
+		if (!pointer && Ordinal != 0)
 			pointer = reinterpret_cast<void *>(GetProcAddress(static_cast<HMODULE>(Module), MAKEINTRESOURCEA(Ordinal)));
 
 		if (!pointer)
@@ -434,6 +4215,138 @@ namespace DllProxy
 		return true;
 	}
 
+	bool ExportDirectoryResolverCallback(void *Module, uint32_t Ordinal, const char *Name, void **FunctionPointer)
+	{
+		// Same lookup order as GetProcAddress in DefaultExportResolverCallback (name, then ordinal) without taking
+		// loader locks. Forwarders are followed.
+		uint32_t depth = 0;
+		void *pointer = Internal::LookupModuleExport(Module, Ordinal, Name, depth);
+
+		if (!pointer)
+			return false;
+
+		*FunctionPointer = pointer;
+		return true;
+	}
+
+#if defined(DLL_PROXY_MEMORY_LIBRARY_LOADER)
+	void *LoadLibraryFromMemory(const void *Image, size_t Size)
+	{
+		return Internal::LoadLibraryFromMemoryImpl(Image, Size);
+	}
+
+	void *MemoryLibraryResolverCallback(const wchar_t *LibraryName)
+	{
+		// The original is embedded as an RT_RCDATA resource named after the library, e.g. WINHTTP.DLL RCDATA "original.dll"
+		const auto module = static_cast<HMODULE>(Internal::GetLocalModuleHandle());
+		const HRSRC resource = FindResourceW(module, LibraryName, RT_RCDATA);
+
+		if (!resource)
+			return nullptr;
+
+		const HGLOBAL data = LoadResource(module, resource);
+		const DWORD size = SizeofResource(module, resource);
+
+		if (!data || size == 0)
+			return nullptr;
+
+		return LoadLibraryFromMemory(LockResource(data), size);
+	}
+#endif // DLL_PROXY_MEMORY_LIBRARY_LOADER
+
+#if defined(DLL_PROXY_IMPORT_TABLE_BYPASS)
+	size_t BypassImportTables()
+	{
+		return Internal::BypassImportTablesImpl();
+	}
+#endif // DLL_PROXY_IMPORT_TABLE_BYPASS
+
+#if defined(DLL_PROXY_ENABLE_INIT_REPORT)
+	const InitReport *GetInitReport()
+	{
+		return &Internal::InitReportData;
+	}
+#endif // DLL_PROXY_ENABLE_INIT_REPORT
+
+#if defined(DLL_PROXY_COLLAPSE_EXPORT_CHAINS)
+	size_t QueryCollapsedExports(CollapsedExport *Exports, size_t Capacity)
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < Section::ExportCount; i++)
+		{
+			const auto depth = Internal::ExportChainDepths[i];
+
+			if (depth == 0)
+				continue;
+
+			if (count < Capacity)
+			{
+				const auto& entry = Section::ExportTable[i];
+
+				Exports[count].Name = entry.Name;
+				Exports[count].Ordinal = entry.Ordinal;
+				Exports[count].Depth = depth;
+			}
+
+			count++;
+		}
+
+		return count;
+	}
+#endif // DLL_PROXY_COLLAPSE_EXPORT_CHAINS
+
+#if defined(DLL_PROXY_ENABLE_CALL_STATS)
+	size_t QueryCallStatistics(CallStatistics *Statistics, size_t Capacity)
+	{
+		const size_t count = Capacity < Section::ExportCount ? Capacity : Section::ExportCount;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto& entry = Section::ExportTable[i];
+
+			Statistics[i].Name = entry.Name;
+			Statistics[i].Ordinal = entry.Ordinal;
+			Statistics[i].CallCount = Internal::ReadCallCounter(entry.Stub);
+		}
+
+		return Section::ExportCount;
+	}
+
+	bool WriteCallStatistics(const wchar_t *FilePath)
+	{
+		const HANDLE file = CreateFileW(FilePath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		const bool status = Internal::WriteCallStatisticsImpl(file);
+
+		CloseHandle(file);
+		return status;
+	}
+#endif // DLL_PROXY_ENABLE_CALL_STATS
+
+#if defined(DLL_PROXY_ENABLE_CALL_TRACING)
+	bool WriteTraceDump(const wchar_t *FilePath)
+	{
+		const HANDLE file = CreateFileW(FilePath, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		const bool status = Internal::WriteTraceDumpImpl(file);
+
+		CloseHandle(file);
+		return status;
+	}
+#endif // DLL_PROXY_ENABLE_CALL_TRACING
+
+	const wchar_t *GetErrorLibraryName()
+	{
+		return Internal::ErrorLibraryName;
+	}
+
 	void DefaultExceptionCallback(ErrorCode Code)
 	{
 		// Avoid a hard dependency on user32.dll
@@ -443,8 +4356,15 @@ namespace DllProxy
 
 			if (messageBox)
 			{
-				wchar_t reason[] = L"Proxy error code during initialization: 0";
-				reason[ARRAYSIZE(reason) - 2] = L'0' + static_cast<uint8_t>(Code);
+				wchar_t reason[MAX_PATH + 64] = L"Proxy error code during initialization: 0";
+				reason[ARRAYSIZE(L"Proxy error code during initialization: 0") - 2] = L'0' + static_cast<uint8_t>(Code);
+
+				if (const auto libraryName = GetErrorLibraryName())
+				{
+					wcscat_s(reason, ARRAYSIZE(reason), L" (");
+					wcsncat_s(reason, ARRAYSIZE(reason), libraryName, _TRUNCATE);
+					wcsncat_s(reason, ARRAYSIZE(reason), L")", _TRUNCATE);
+				}
 
 				messageBox(nullptr, reason, L"Proxy DLL Fatal Error", MB_ICONERROR);
 			}
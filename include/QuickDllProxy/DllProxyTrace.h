@@ -0,0 +1,56 @@
+//
+// Binary layout of the dumps written by DllProxy::WriteTraceDump when DLL_PROXY_ENABLE_CALL_TRACING is defined. This
+// header has no Windows dependencies so host-side tools can decode dumps on any platform.
+//
+//   FileHeader
+//   ExportEntry[ExportCount], each followed by NameLength bytes of the export name (not null terminated)
+//   Record[RecordCount]
+//
+// Timestamps are raw rdtsc values. StartCounter/StartTimestamp and EndCounter/EndTimestamp are QueryPerformanceCounter
+// and rdtsc pairs sampled during DllProxy::Initialize and while writing the dump. They can be used to convert
+// timestamps to seconds. AbandonedCount is the number of traced calls that were left through longjmp or an exception,
+// or whose swapped return address was put back for one, and so have no record.
+//
+#if !defined(DLLPROXYTRACE_H_DEDUP)
+#define DLLPROXYTRACE_H_DEDUP
+
+#include <cstdint>
+
+namespace DllProxy::Trace
+{
+	constexpr char FileMagic[8] = { 'D', 'L', 'P', 'X', 'T', 'R', 'C', 'E' };
+	constexpr std::uint32_t FileVersion = 2;
+
+	struct FileHeader
+	{
+		char Magic[8];
+		std::uint32_t Version;
+		std::uint32_t ExportCount;
+		std::uint64_t RecordCount;
+		std::uint64_t AbandonedCount;
+		std::uint64_t CounterFrequency;
+		std::uint64_t StartCounter;
+		std::uint64_t StartTimestamp;
+		std::uint64_t EndCounter;
+		std::uint64_t EndTimestamp;
+	};
+	static_assert(sizeof(FileHeader) == 72, "Dump header layout changed");
+
+	struct ExportEntry
+	{
+		std::uint32_t Ordinal; // 0 if the listing didn't specify one
+		std::uint32_t NameLength;
+	};
+	static_assert(sizeof(ExportEntry) == 8, "Dump export entry layout changed");
+
+	struct Record
+	{
+		std::uint32_t ExportIndex;
+		std::uint32_t ThreadId;
+		std::uint64_t EnterTimestamp;
+		std::uint64_t LeaveTimestamp;
+	};
+	static_assert(sizeof(Record) == 24, "Dump record layout changed");
+}
+
+#endif // !DLLPROXYTRACE_H_DEDUP
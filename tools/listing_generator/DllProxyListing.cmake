@@ -0,0 +1,82 @@
+#
+# dllproxy_generate_listing(<target> INPUT <dll> OUTPUT <listing.inc> [LIBRARY <name>] [NO_ORDINALS] [ORDINAL_RANGES]
+#                           [PROFILE <file>])
+#
+# Regenerates <listing.inc> from <dll> at build time whenever the DLL or profile changes and adds its directory to
+# <target>'s include path. The generator only rewrites the listing when its contents differ, so DLL updates that keep
+# the same exports don't recompile the proxy. A stamp file next to the target's build files records each run, which
+# keeps every generator from rerunning it on the next build when the listing was left alone.
+#
+# The generator must run on the build machine. Either build tools/ in the same tree so the
+# dllproxy_listing_generator target exists, or point DLLPROXY_LISTING_GENERATOR at a prebuilt executable, e.g. when
+# cross compiling proxies with mingw-w64.
+#
+set(DLLPROXY_LISTING_GENERATOR "" CACHE FILEPATH "Prebuilt dllproxy_listing_generator used when the target isn't part of this build")
+
+function(dllproxy_generate_listing TARGET_NAME)
+	cmake_parse_arguments(PARSE_ARGV 1 ARG "NO_ORDINALS;ORDINAL_RANGES" "INPUT;OUTPUT;LIBRARY;PROFILE" "")
+
+	if(NOT ARG_INPUT OR NOT ARG_OUTPUT)
+		message(FATAL_ERROR "dllproxy_generate_listing requires INPUT and OUTPUT")
+	endif()
+
+	if(TARGET dllproxy_listing_generator)
+		set(GENERATOR_COMMAND $<TARGET_FILE:dllproxy_listing_generator>)
+		set(GENERATOR_DEPENDS dllproxy_listing_generator)
+	elseif(DLLPROXY_LISTING_GENERATOR)
+		set(GENERATOR_COMMAND "${DLLPROXY_LISTING_GENERATOR}")
+		set(GENERATOR_DEPENDS "${DLLPROXY_LISTING_GENERATOR}")
+	else()
+		message(FATAL_ERROR "dllproxy_generate_listing needs the dllproxy_listing_generator target or DLLPROXY_LISTING_GENERATOR")
+	endif()
+
+	set(GENERATOR_ARGS -o "${ARG_OUTPUT}")
+
+	if(ARG_LIBRARY)
+		list(APPEND GENERATOR_ARGS --library "${ARG_LIBRARY}")
+	endif()
+
+	if(ARG_NO_ORDINALS)
+		list(APPEND GENERATOR_ARGS --no-ordinals)
+	endif()
+
+	# Runs of NONAME exports become a DECLARE_PROXIED_API_ORDINAL_RANGE on GNU toolchains and a line per ordinal on MSVC
+	if(ARG_ORDINAL_RANGES)
+		list(APPEND GENERATOR_ARGS --ordinal-ranges)
+	endif()
+
+	# Call counts from DllProxy::WriteCallStatistics. The hottest exports get the first stubs.
+	if(ARG_PROFILE)
+		list(APPEND GENERATOR_ARGS --profile "${ARG_PROFILE}")
+		list(APPEND GENERATOR_DEPENDS "${ARG_PROFILE}")
+	endif()
+
+	get_filename_component(OUTPUT_DIR "${ARG_OUTPUT}" DIRECTORY)
+	get_filename_component(OUTPUT_NAME "${ARG_OUTPUT}" NAME)
+	set(STAMP_FILE "${CMAKE_CURRENT_BINARY_DIR}/${TARGET_NAME}_${OUTPUT_NAME}.stamp")
+
+	# The listing keeps its old timestamp when nothing changed, so it can't be the output the build checks against
+	add_custom_command(
+		OUTPUT "${STAMP_FILE}"
+		BYPRODUCTS "${ARG_OUTPUT}"
+		COMMAND ${CMAKE_COMMAND} -E make_directory "${OUTPUT_DIR}"
+		COMMAND ${GENERATOR_COMMAND} ${GENERATOR_ARGS} "${ARG_INPUT}"
+		COMMAND ${CMAKE_COMMAND} -E touch "${STAMP_FILE}"
+		DEPENDS "${ARG_INPUT}" ${GENERATOR_DEPENDS}
+		COMMENT "Generating export listing ${ARG_OUTPUT}"
+		VERBATIM
+	)
+
+	target_sources(
+		${TARGET_NAME}
+		PRIVATE
+			"${STAMP_FILE}"
+			"${ARG_OUTPUT}"
+	)
+
+	target_include_directories(
+		${TARGET_NAME}
+		PRIVATE
+			"${OUTPUT_DIR}"
+	)
+endfunction()
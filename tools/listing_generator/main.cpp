@@ -0,0 +1,675 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+//
+// Minimal PE definitions so the tool doesn't depend on Windows headers
+//
+namespace Pe
+{
+	constexpr std::uint16_t DosSignature = 0x5A4D;		 // MZ
+	constexpr std::uint32_t NtSignature = 0x00004550;	 // PE\0\0
+	constexpr std::uint16_t OptionalMagic32 = 0x10B;
+	constexpr std::uint16_t OptionalMagic64 = 0x20B;
+	constexpr std::uint32_t SectionExecute = 0x20000000; // IMAGE_SCN_MEM_EXECUTE
+	constexpr std::uint32_t SectionCode = 0x00000020;	 // IMAGE_SCN_CNT_CODE
+
+#pragma pack(push, 1)
+	struct DosHeader
+	{
+		std::uint16_t Magic;
+		std::uint8_t Unused[58];
+		std::int32_t NtHeadersOffset;
+	};
+
+	struct FileHeader
+	{
+		std::uint16_t Machine;
+		std::uint16_t NumberOfSections;
+		std::uint32_t TimeDateStamp;
+		std::uint32_t PointerToSymbolTable;
+		std::uint32_t NumberOfSymbols;
+		std::uint16_t SizeOfOptionalHeader;
+		std::uint16_t Characteristics;
+	};
+
+	struct DataDirectory
+	{
+		std::uint32_t VirtualAddress;
+		std::uint32_t Size;
+	};
+
+	struct SectionHeader
+	{
+		char Name[8];
+		std::uint32_t VirtualSize;
+		std::uint32_t VirtualAddress;
+		std::uint32_t SizeOfRawData;
+		std::uint32_t PointerToRawData;
+		std::uint32_t PointerToRelocations;
+		std::uint32_t PointerToLinenumbers;
+		std::uint16_t NumberOfRelocations;
+		std::uint16_t NumberOfLinenumbers;
+		std::uint32_t Characteristics;
+	};
+
+	struct ExportDirectory
+	{
+		std::uint32_t Characteristics;
+		std::uint32_t TimeDateStamp;
+		std::uint16_t MajorVersion;
+		std::uint16_t MinorVersion;
+		std::uint32_t Name;
+		std::uint32_t Base;
+		std::uint32_t NumberOfFunctions;
+		std::uint32_t NumberOfNames;
+		std::uint32_t AddressOfFunctions;
+		std::uint32_t AddressOfNames;
+		std::uint32_t AddressOfNameOrdinals;
+	};
+#pragma pack(pop)
+
+	// Offsets of NumberOfRvaAndSizes within IMAGE_OPTIONAL_HEADER32/64. The data directory array follows it.
+	constexpr size_t RvaCountOffset32 = 92;
+	constexpr size_t RvaCountOffset64 = 108;
+}
+
+class MappedFile
+{
+public:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	explicit MappedFile(const fs::path& FilePath)
+	{
+#if defined(_WIN32)
+		const HANDLE file = CreateFileW(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER fileSize;
+
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			if (const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+			{
+				m_Data = static_cast<const std::uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				m_Size = m_Data ? static_cast<size_t>(fileSize.QuadPart) : 0;
+				CloseHandle(mapping);
+			}
+		}
+
+		CloseHandle(file);
+#else
+		const int fd = open(FilePath.c_str(), O_RDONLY);
+
+		if (fd < 0)
+			return;
+
+		struct stat fileStat;
+
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			if (void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0); data != MAP_FAILED)
+			{
+				m_Data = static_cast<const std::uint8_t *>(data);
+				m_Size = static_cast<size_t>(fileStat.st_size);
+			}
+		}
+
+		close(fd);
+#endif
+	}
+
+	~MappedFile()
+	{
+		if (!m_Data)
+			return;
+
+#if defined(_WIN32)
+		UnmapViewOfFile(m_Data);
+#else
+		munmap(const_cast<std::uint8_t *>(m_Data), m_Size);
+#endif
+	}
+
+	const std::uint8_t *Data() const
+	{
+		return m_Data;
+	}
+
+	size_t Size() const
+	{
+		return m_Size;
+	}
+
+private:
+	const std::uint8_t *m_Data = nullptr;
+	size_t m_Size = 0;
+};
+
+// Read-only view over a PE file on disk. Nothing is copied. Every accessor bounds checks against the mapping.
+class PeFileView
+{
+public:
+	PeFileView(const std::uint8_t *Data, size_t Size) : m_Data(Data), m_Size(Size)
+	{
+	}
+
+	const char *Parse()
+	{
+		const auto dosHeader = At<Pe::DosHeader>(0);
+
+		if (!dosHeader || dosHeader->Magic != Pe::DosSignature || dosHeader->NtHeadersOffset < 0)
+			return "missing DOS header";
+
+		const size_t ntOffset = static_cast<size_t>(dosHeader->NtHeadersOffset);
+		const auto signature = At<std::uint32_t>(ntOffset);
+		const auto fileHeader = At<Pe::FileHeader>(ntOffset + sizeof(std::uint32_t));
+
+		if (!signature || *signature != Pe::NtSignature || !fileHeader)
+			return "missing NT headers";
+
+		const size_t optionalOffset = ntOffset + sizeof(std::uint32_t) + sizeof(Pe::FileHeader);
+		const auto optionalMagic = At<std::uint16_t>(optionalOffset);
+		size_t rvaCountOffset = 0;
+
+		if (optionalMagic && *optionalMagic == Pe::OptionalMagic32)
+			rvaCountOffset = optionalOffset + Pe::RvaCountOffset32;
+		else if (optionalMagic && *optionalMagic == Pe::OptionalMagic64)
+			rvaCountOffset = optionalOffset + Pe::RvaCountOffset64;
+		else
+			return "unknown optional header magic";
+
+		const auto rvaCount = At<std::uint32_t>(rvaCountOffset);
+		const auto sections = At<Pe::SectionHeader>(optionalOffset + fileHeader->SizeOfOptionalHeader, fileHeader->NumberOfSections);
+
+		if (!rvaCount || !sections)
+			return "truncated headers";
+
+		m_Sections = sections;
+		m_SectionCount = fileHeader->NumberOfSections;
+
+		if (*rvaCount == 0)
+			return nullptr;
+
+		const auto exportDataDirectory = At<Pe::DataDirectory>(rvaCountOffset + sizeof(std::uint32_t));
+
+		if (!exportDataDirectory)
+			return "truncated data directories";
+
+		m_ExportDirectoryStart = exportDataDirectory->VirtualAddress;
+		m_ExportDirectoryEnd = exportDataDirectory->VirtualAddress + exportDataDirectory->Size;
+
+		if (exportDataDirectory->VirtualAddress != 0)
+		{
+			m_ExportDirectory = AtRva<Pe::ExportDirectory>(exportDataDirectory->VirtualAddress);
+
+			if (!m_ExportDirectory)
+				return "export directory is outside of the file";
+		}
+
+		return nullptr;
+	}
+
+	template<typename T>
+	const T *At(size_t Offset, size_t Count = 1) const
+	{
+		if (Offset > m_Size || Count > (m_Size - Offset) / sizeof(T))
+			return nullptr;
+
+		return reinterpret_cast<const T *>(m_Data + Offset);
+	}
+
+	template<typename T>
+	const T *AtRva(std::uint32_t Rva, size_t Count = 1) const
+	{
+		const auto section = FindSection(Rva);
+
+		if (!section)
+			return nullptr;
+
+		const size_t sectionOffset = Rva - section->VirtualAddress;
+
+		// Reject anything that spills out of the section's raw data
+		if (sectionOffset > section->SizeOfRawData || Count > (section->SizeOfRawData - sectionOffset) / sizeof(T))
+			return nullptr;
+
+		return At<T>(section->PointerToRawData + sectionOffset, Count);
+	}
+
+	std::string_view StringAtRva(std::uint32_t Rva) const
+	{
+		const auto section = FindSection(Rva);
+
+		if (!section || Rva - section->VirtualAddress >= section->SizeOfRawData)
+			return {};
+
+		const size_t start = section->PointerToRawData + (Rva - section->VirtualAddress);
+		const size_t limit = std::min<size_t>(m_Size, section->PointerToRawData + section->SizeOfRawData);
+
+		if (start >= limit)
+			return {};
+
+		const auto begin = reinterpret_cast<const char *>(m_Data + start);
+		const auto end = static_cast<const char *>(memchr(begin, '\0', limit - start));
+
+		return end ? std::string_view(begin, end - begin) : std::string_view();
+	}
+
+	const Pe::SectionHeader *FindSection(std::uint32_t Rva) const
+	{
+		for (size_t i = 0; i < m_SectionCount; i++)
+		{
+			const auto& section = m_Sections[i];
+			const std::uint32_t length = std::max(section.VirtualSize, section.SizeOfRawData);
+
+			if (Rva >= section.VirtualAddress && Rva - section.VirtualAddress < length)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	const Pe::ExportDirectory *Exports() const
+	{
+		return m_ExportDirectory;
+	}
+
+	bool IsForwarderRva(std::uint32_t Rva) const
+	{
+		return Rva >= m_ExportDirectoryStart && Rva < m_ExportDirectoryEnd;
+	}
+
+private:
+	const std::uint8_t *m_Data;
+	size_t m_Size;
+	const Pe::SectionHeader *m_Sections = nullptr;
+	size_t m_SectionCount = 0;
+	const Pe::ExportDirectory *m_ExportDirectory = nullptr;
+	std::uint32_t m_ExportDirectoryStart = 0;
+	std::uint32_t m_ExportDirectoryEnd = 0;
+};
+
+struct GeneratorOptions
+{
+	std::string LibraryName;
+	bool EmitOrdinals = true;
+	bool OrdinalRanges = false;
+	std::string ProfileName;
+	std::unordered_map<std::string, std::uint64_t> CallCounts; // Export name -> calls. Empty keeps ordinal order.
+};
+
+static bool LoadProfile(const fs::path& ProfilePath, GeneratorOptions& Options)
+{
+	// "<count> <name>" per line, as written by DllProxy::WriteCallStatistics. Blank lines and # comments are skipped.
+	std::ifstream file(ProfilePath);
+
+	if (!file)
+		return false;
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		const auto first = line.find_first_not_of(" \t\r");
+
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		char *nameStart = nullptr;
+		const std::uint64_t count = strtoull(line.c_str() + first, &nameStart, 10);
+		std::string_view name(nameStart);
+
+		name.remove_prefix(std::min(name.find_first_not_of(" \t"), name.size()));
+		name = name.substr(0, name.find_first_of(" \t\r"));
+
+		if (!name.empty())
+			Options.CallCounts[std::string(name)] += count;
+	}
+
+	Options.ProfileName = ProfilePath.filename().string();
+	return true;
+}
+
+static bool GenerateListing(const fs::path& InputPath, const GeneratorOptions& Options, std::string& Listing, std::string& Error)
+{
+	const MappedFile file(InputPath);
+
+	if (!file.Data())
+	{
+		Error = "unable to map file";
+		return false;
+	}
+
+	PeFileView view(file.Data(), file.Size());
+
+	if (const auto parseError = view.Parse())
+	{
+		Error = parseError;
+		return false;
+	}
+
+	const auto directory = view.Exports();
+	const std::string libraryName = Options.LibraryName.empty() ? InputPath.filename().string() : Options.LibraryName;
+
+	Listing = "// Generated by dllproxy_listing_generator from " + InputPath.filename().string();
+
+	if (!Options.ProfileName.empty())
+		Listing += ", ordered by calls in " + Options.ProfileName;
+
+	Listing += "\n";
+	Listing += "DECLARE_PROXIED_LIBRARY(\"" + libraryName + "\")\n";
+
+	if (!directory)
+		return true;
+
+	const auto functions = view.AtRva<std::uint32_t>(directory->AddressOfFunctions, directory->NumberOfFunctions);
+	const auto names = view.AtRva<std::uint32_t>(directory->AddressOfNames, directory->NumberOfNames);
+	const auto nameOrdinals = view.AtRva<std::uint16_t>(directory->AddressOfNameOrdinals, directory->NumberOfNames);
+
+	if ((directory->NumberOfFunctions && !functions) || (directory->NumberOfNames && (!names || !nameOrdinals)))
+	{
+		Error = "export tables are outside of the file";
+		return false;
+	}
+
+	// Names are sorted alphabetically in the file. Group them by function index so output follows ordinal order.
+	struct NamedExport
+	{
+		std::uint32_t FunctionIndex;
+		std::string_view Name;
+	};
+
+	std::vector<NamedExport> namedExports;
+	std::vector<bool> hasName(directory->NumberOfFunctions, false);
+
+	namedExports.reserve(directory->NumberOfNames);
+
+	for (std::uint32_t i = 0; i < directory->NumberOfNames; i++)
+	{
+		if (nameOrdinals[i] >= directory->NumberOfFunctions)
+			continue;
+
+		namedExports.push_back({ nameOrdinals[i], view.StringAtRva(names[i]) });
+		hasName[nameOrdinals[i]] = true;
+	}
+
+	// NONAME exports use the same "Ordinal_N" placeholder the hand-written listings do
+	for (std::uint32_t i = 0; i < directory->NumberOfFunctions; i++)
+	{
+		if (!hasName[i])
+			namedExports.push_back({ i, {} });
+	}
+
+	std::stable_sort(namedExports.begin(), namedExports.end(), [](const NamedExport& A, const NamedExport& B)
+	{
+		return A.FunctionIndex < B.FunctionIndex;
+	});
+
+	// Stubs are laid out in listing order. With a profile, the most called exports move to the front so they share
+	// cache lines and pages. Everything else keeps ordinal order behind them.
+	struct ListingLine
+	{
+		std::string Text;
+		std::uint64_t Calls;
+		std::uint32_t RangeOrdinal; // Nonzero for NONAME function exports that --ordinal-ranges can merge
+	};
+
+	std::vector<ListingLine> lines;
+	char line[1024];
+
+	for (size_t i = 0; i < namedExports.size(); i++)
+	{
+		const auto& namedExport = namedExports[i];
+		const std::uint32_t rva = functions[namedExport.FunctionIndex];
+		const std::uint32_t ordinal = directory->Base + namedExport.FunctionIndex;
+
+		// Unused slots in the ordinal range
+		if (rva == 0)
+			continue;
+
+		std::string name(namedExport.Name);
+
+		if (name.empty())
+			name = "Ordinal_" + std::to_string(ordinal);
+
+		// An ordinal can only be exported once. Extra names for the same function are declared by name alone.
+		const bool aliasOfPrevious = i > 0 && namedExports[i - 1].FunctionIndex == namedExport.FunctionIndex;
+
+		if ((Options.EmitOrdinals && !aliasOfPrevious) || namedExport.Name.empty())
+			snprintf(line, sizeof(line), "DECLARE_PROXIED_API_ORDINAL(\"%s\", %u)", name.c_str(), ordinal);
+		else
+			snprintf(line, sizeof(line), "DECLARE_PROXIED_API(\"%s\")", name.c_str());
+
+		const auto calls = Options.CallCounts.find(name);
+		auto& listingLine = lines.emplace_back(ListingLine { line, calls != Options.CallCounts.end() ? calls->second : 0, namedExport.Name.empty() ? ordinal : 0 });
+
+		if (view.IsForwarderRva(rva))
+		{
+			// The export resolvers follow forwarders, so these are proxied like any other function
+			listingLine.Text += " // Forwarded to ";
+			listingLine.Text += view.StringAtRva(rva);
+			listingLine.RangeOrdinal = 0;
+		}
+		else if (const auto section = view.FindSection(rva); section && !(section->Characteristics & (Pe::SectionExecute | Pe::SectionCode)))
+		{
+			// Exported global variables can't be proxied through a stub
+			listingLine.Text = "// " + listingLine.Text + " // Data export, not supported";
+			listingLine.Calls = 0;
+			listingLine.RangeOrdinal = 0;
+		}
+	}
+
+	std::stable_sort(lines.begin(), lines.end(), [](const ListingLine& A, const ListingLine& B)
+	{
+		return A.Calls > B.Calls;
+	});
+
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		// Consecutive NONAME ordinals collapse into one line, which compiles much faster in listings with thousands
+		// of them. A profile can still split a run since merging only looks at neighbouring lines.
+		size_t last = i;
+
+		if (Options.OrdinalRanges && lines[i].RangeOrdinal != 0)
+		{
+			while (last + 1 < lines.size() && lines[last + 1].RangeOrdinal == lines[last].RangeOrdinal + 1)
+				last++;
+		}
+
+		if (last != i)
+		{
+			// MSVC can't export a range, so it gets the same run one ordinal per line
+			Listing += "#if defined(_MSC_VER)\n";
+
+			for (size_t j = i; j <= last; j++)
+			{
+				Listing += lines[j].Text;
+				Listing += "\n";
+			}
+
+			snprintf(line, sizeof(line), "DECLARE_PROXIED_API_ORDINAL_RANGE(%u, %u)", lines[i].RangeOrdinal, lines[last].RangeOrdinal);
+			Listing += "#else\n";
+			Listing += line;
+			Listing += "\n#endif";
+			i = last;
+		}
+		else
+		{
+			Listing += lines[i].Text;
+		}
+
+		Listing += "\n";
+	}
+
+	return true;
+}
+
+static bool WriteIfDifferent(const fs::path& OutputPath, const std::string& Contents)
+{
+	// Leave the file alone when nothing changed so build systems don't recompile the proxy
+	if (std::ifstream existing(OutputPath, std::ios::binary); existing)
+	{
+		const std::string previous((std::istreambuf_iterator<char>(existing)), std::istreambuf_iterator<char>());
+
+		if (previous == Contents)
+			return true;
+	}
+
+	std::ofstream output(OutputPath, std::ios::binary | std::ios::trunc);
+	output.write(Contents.data(), Contents.size());
+
+	return static_cast<bool>(output);
+}
+
+static bool IsDllPath(const fs::path& FilePath)
+{
+	auto extension = FilePath.extension().string();
+
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char C) { return static_cast<char>(tolower(C)); });
+	return extension == ".dll";
+}
+
+static void PrintUsage(const char *ProgramName)
+{
+	fprintf(stderr,
+		"Usage: %s [options] <file.dll | directory>...\n"
+		"\n"
+		"  -o <path>        Output file for a single input, or output directory for several inputs or a directory\n"
+		"                   input. Listings written to a directory are named <dll name>_exports.inc. Defaults to stdout.\n"
+		"  --library <name> Name used in DECLARE_PROXIED_LIBRARY. Defaults to the input file name.\n"
+		"  --no-ordinals    Emit DECLARE_PROXIED_API for named exports. NONAME exports always keep their ordinal.\n"
+		"  --ordinal-ranges Merge runs of consecutive NONAME exports into DECLARE_PROXIED_API_ORDINAL_RANGE for GNU\n"
+		"                   toolchains. MSVC builds of the same listing still see one line per ordinal.\n"
+		"  --profile <file> Put the most called exports first. Each line is \"<count> <name>\", e.g. the output of\n"
+		"                   DllProxy::WriteCallStatistics.\n",
+		ProgramName);
+}
+
+int main(int argc, char **argv)
+{
+	GeneratorOptions options;
+	fs::path outputPath;
+	std::vector<fs::path> inputs;
+	bool directoryInput = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string_view argument = argv[i];
+
+		if (argument == "-o" && i + 1 < argc)
+			outputPath = argv[++i];
+		else if (argument == "--library" && i + 1 < argc)
+			options.LibraryName = argv[++i];
+		else if (argument == "--no-ordinals")
+			options.EmitOrdinals = false;
+		else if (argument == "--ordinal-ranges")
+			options.OrdinalRanges = true;
+		else if (argument == "--profile" && i + 1 < argc)
+		{
+			if (!LoadProfile(argv[++i], options))
+			{
+				fprintf(stderr, "Unable to read profile %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (argument.starts_with("-"))
+		{
+			PrintUsage(argv[0]);
+			return argument == "-h" || argument == "--help" ? 0 : 1;
+		}
+		else if (std::error_code ec; fs::is_directory(argument, ec))
+		{
+			directoryInput = true;
+
+			for (const auto& entry : fs::directory_iterator(argument, ec))
+			{
+				if (entry.is_regular_file(ec) && IsDllPath(entry.path()))
+					inputs.push_back(entry.path());
+			}
+		}
+		else
+			inputs.emplace_back(argument);
+	}
+
+	if (inputs.empty())
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	const bool multipleOutputs = directoryInput || inputs.size() > 1;
+
+	if (multipleOutputs)
+	{
+		if (outputPath.empty())
+		{
+			fprintf(stderr, "-o <directory> is required when generating more than one listing\n");
+			return 1;
+		}
+
+		if (!options.LibraryName.empty())
+		{
+			fprintf(stderr, "--library can only be used with a single input\n");
+			return 1;
+		}
+
+		std::error_code ec;
+		fs::create_directories(outputPath, ec);
+	}
+
+	std::sort(inputs.begin(), inputs.end());
+
+	std::string listing;
+	std::string error;
+	int failures = 0;
+
+	for (const auto& input : inputs)
+	{
+		if (!GenerateListing(input, options, listing, error))
+		{
+			fprintf(stderr, "%s: %s\n", input.string().c_str(), error.c_str());
+			failures++;
+			continue;
+		}
+
+		if (outputPath.empty())
+		{
+			fwrite(listing.data(), 1, listing.size(), stdout);
+			continue;
+		}
+
+		const auto destination = multipleOutputs ? outputPath / (input.stem().string() + "_exports.inc") : outputPath;
+
+		if (!WriteIfDifferent(destination, listing))
+		{
+			fprintf(stderr, "%s: unable to write %s\n", input.string().c_str(), destination.string().c_str());
+			failures++;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
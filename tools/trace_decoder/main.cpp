@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#include <QuickDllProxy/DllProxyTrace.h>
+
+using namespace DllProxy;
+
+struct ExportSummary
+{
+	std::string Name;
+	std::uint32_t Ordinal = 0;
+	std::vector<std::uint64_t> Durations;
+	std::uint64_t TotalDuration = 0;
+};
+
+struct TraceDump
+{
+	Trace::FileHeader Header {};
+	std::vector<ExportSummary> Exports;
+	std::vector<Trace::Record> Records;
+};
+
+static bool LoadTraceDump(const char *FilePath, TraceDump& Dump)
+{
+	std::ifstream file(FilePath, std::ios::binary);
+
+	if (!file)
+	{
+		fprintf(stderr, "Unable to open %s\n", FilePath);
+		return false;
+	}
+
+	const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	size_t offset = 0;
+
+	const auto read = [&](void *Destination, size_t Length)
+	{
+		if (data.size() - offset < Length)
+			return false;
+
+		memcpy(Destination, data.data() + offset, Length);
+		offset += Length;
+		return true;
+	};
+
+	if (!read(&Dump.Header, sizeof(Dump.Header)) || memcmp(Dump.Header.Magic, Trace::FileMagic, sizeof(Trace::FileMagic)) != 0)
+	{
+		fprintf(stderr, "%s isn't a DllProxy trace dump\n", FilePath);
+		return false;
+	}
+
+	if (Dump.Header.Version != Trace::FileVersion)
+	{
+		fprintf(stderr, "Unsupported dump version %u (expected %u)\n", Dump.Header.Version, Trace::FileVersion);
+		return false;
+	}
+
+	Dump.Exports.resize(Dump.Header.ExportCount);
+
+	for (auto& summary : Dump.Exports)
+	{
+		Trace::ExportEntry entry;
+
+		if (!read(&entry, sizeof(entry)) || data.size() - offset < entry.NameLength)
+		{
+			fprintf(stderr, "Truncated export table\n");
+			return false;
+		}
+
+		summary.Name.assign(data.data() + offset, entry.NameLength);
+		summary.Ordinal = entry.Ordinal;
+		offset += entry.NameLength;
+	}
+
+	if ((data.size() - offset) / sizeof(Trace::Record) < Dump.Header.RecordCount)
+	{
+		fprintf(stderr, "Truncated record table\n");
+		return false;
+	}
+
+	Dump.Records.resize(Dump.Header.RecordCount);
+	return read(Dump.Records.data(), Dump.Records.size() * sizeof(Trace::Record));
+}
+
+static std::uint64_t Percentile(const std::vector<std::uint64_t>& Sorted, double Fraction)
+{
+	return Sorted[std::min(Sorted.size() - 1, static_cast<size_t>(Fraction * Sorted.size()))];
+}
+
+static void PrintHistogram(const ExportSummary& Summary, double TicksPerUnit, const char *Unit)
+{
+	// Log2 buckets of raw ticks, labelled in the display unit
+	std::uint64_t buckets[64] = {};
+	std::uint64_t largestBucket = 0;
+	int firstBucket = 63;
+	int lastBucket = 0;
+
+	for (const auto duration : Summary.Durations)
+	{
+		int bucket = 0;
+
+		while (bucket < 63 && (duration >> (bucket + 1)) != 0)
+			bucket++;
+
+		largestBucket = std::max(largestBucket, ++buckets[bucket]);
+		firstBucket = std::min(firstBucket, bucket);
+		lastBucket = std::max(lastBucket, bucket);
+	}
+
+	printf("\n%s", Summary.Name.c_str());
+
+	if (Summary.Ordinal != 0)
+		printf(" @%u", Summary.Ordinal);
+
+	printf("\n");
+
+	for (int bucket = firstBucket; bucket <= lastBucket; bucket++)
+	{
+		const double low = static_cast<double>(bucket == 0 ? 0 : 1ull << bucket) / TicksPerUnit;
+		const double high = static_cast<double>(1ull << std::min(bucket + 1, 63)) / TicksPerUnit;
+		const int barLength = static_cast<int>((buckets[bucket] * 40 + largestBucket - 1) / largestBucket);
+
+		printf("  [%12.3f, %12.3f) %-3s %10" PRIu64 " %.*s\n", low, high, Unit, buckets[bucket], barLength, "########################################");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <trace dump> [--top N] [--cycles]\n", argv[0]);
+		return 1;
+	}
+
+	size_t histogramCount = 10;
+	bool forceCycles = false;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+			histogramCount = strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--cycles") == 0)
+			forceCycles = true;
+	}
+
+	TraceDump dump;
+
+	if (!LoadTraceDump(argv[1], dump))
+		return 1;
+
+	// rdtsc ticks are converted to microseconds when the dump carries a usable QueryPerformanceCounter pair
+	const auto& header = dump.Header;
+	double ticksPerUnit = 1.0;
+	const char *unit = "cyc";
+
+	if (!forceCycles && header.CounterFrequency != 0 && header.EndCounter > header.StartCounter && header.EndTimestamp > header.StartTimestamp)
+	{
+		const double elapsedMicroseconds = static_cast<double>(header.EndCounter - header.StartCounter) * 1000000.0 / static_cast<double>(header.CounterFrequency);
+
+		ticksPerUnit = static_cast<double>(header.EndTimestamp - header.StartTimestamp) / elapsedMicroseconds;
+		unit = "us";
+	}
+
+	std::set<std::uint32_t> threads;
+	std::uint64_t discardedRecords = 0;
+
+	for (const auto& record : dump.Records)
+	{
+		// Torn records from a dump taken while calls were in flight, or timestamps from unsynchronized cores
+		if (record.ExportIndex >= dump.Exports.size() || record.LeaveTimestamp < record.EnterTimestamp)
+		{
+			discardedRecords++;
+			continue;
+		}
+
+		auto& summary = dump.Exports[record.ExportIndex];
+		const auto duration = record.LeaveTimestamp - record.EnterTimestamp;
+
+		summary.Durations.push_back(duration);
+		summary.TotalDuration += duration;
+		threads.insert(record.ThreadId);
+	}
+
+	std::vector<ExportSummary *> ranked;
+
+	for (auto& summary : dump.Exports)
+	{
+		if (summary.Durations.empty())
+			continue;
+
+		std::sort(summary.Durations.begin(), summary.Durations.end());
+		ranked.push_back(&summary);
+	}
+
+	std::sort(ranked.begin(), ranked.end(), [](const ExportSummary *A, const ExportSummary *B)
+	{
+		return A->TotalDuration > B->TotalDuration;
+	});
+
+	printf("%" PRIu64 " records from %zu threads across %zu of %u exports (%" PRIu64 " discarded). Times in %s.\n\n",
+		header.RecordCount, threads.size(), ranked.size(), header.ExportCount, discardedRecords, unit);
+
+	// These never made it into a record, so the numbers below under-count them
+	if (header.AbandonedCount)
+		printf("%" PRIu64 " calls were lost to exceptions or longjmp and aren't included.\n\n", header.AbandonedCount);
+
+	printf("%-40s %8s %10s %14s %12s %12s %12s %12s\n", "export", "ordinal", "calls", "total", "mean", "p50", "p99", "max");
+
+	for (const auto summary : ranked)
+	{
+		const auto& durations = summary->Durations;
+		const auto scale = [&](std::uint64_t Ticks) { return static_cast<double>(Ticks) / ticksPerUnit; };
+
+		printf("%-40s %8u %10zu %14.3f %12.3f %12.3f %12.3f %12.3f\n",
+			summary->Name.c_str(),
+			summary->Ordinal,
+			durations.size(),
+			scale(summary->TotalDuration),
+			scale(summary->TotalDuration) / durations.size(),
+			scale(Percentile(durations, 0.50)),
+			scale(Percentile(durations, 0.99)),
+			scale(durations.back()));
+	}
+
+	for (size_t i = 0; i < ranked.size() && i < histogramCount; i++)
+		PrintHistogram(*ranked[i], ticksPerUnit, unit);
+
+	return 0;
+}